@@ -0,0 +1,116 @@
+// Microbenchmark DominanceKernels::weaklyDominatedRun: scalar / SSE2 / AVX2
+// trên các đoạn 1024 phần tử.
+//
+// Build (từ thư mục gốc repo):
+//   g++ -std=c++17 -O2 -mavx2 -Isrc/header bench/dominance_kernels.cpp src/ObjectiveStore.cpp -o /tmp/bench_dominance
+// Không có -mavx2 thì chỉ đo scalar và SSE2.
+//
+// Mỗi lần gọi, ứng viên trội đoạn đầu dài runLength rồi dừng (runLength = 1024
+// → quét hết). Kết quả mọi đường được đối chiếu với scalar trước khi đo.
+#include "ObjectiveStore.h"
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+#include <algorithm>
+
+namespace {
+
+const size_t ENTRIES = 1024;
+const int REPEATS = 20000;
+const int TRIALS = 7;
+
+typedef size_t (*Kernel)(const double*, const double*, size_t, double, double);
+
+struct Workload {
+    std::vector<double> cts, wts;
+    std::vector<double> candCt, candWt;  // một ứng viên cho mỗi lần gọi
+};
+
+// Staircase như trong ParetoArchive: ct tăng, wt giảm. Ứng viên (ct, wt) trội
+// đúng runLength phần tử đầu.
+Workload makeWorkload(size_t runLength, std::mt19937& rng) {
+    Workload w;
+    std::uniform_real_distribution<double> step(1.0, 10.0);
+    double ct = 1000, wt = 1e6;
+    for (size_t i = 0; i < ENTRIES; i++) {
+        ct += step(rng);
+        wt -= step(rng);
+        w.cts.push_back(ct);
+        w.wts.push_back(wt);
+    }
+    // ct nhỏ hơn mọi phần tử; wt <= wts[i] với i < runLength, > wts[runLength]
+    double minWt = runLength < ENTRIES ? w.wts[runLength - 1] : w.wts[ENTRIES - 1];
+    for (int r = 0; r < 64; r++) {
+        w.candCt.push_back(500 + r);
+        w.candWt.push_back(minWt - (runLength < ENTRIES ? 0 : 1));
+    }
+    return w;
+}
+
+double timeKernel(Kernel kernel, const Workload& w, size_t& checksum) {
+    double best = 1e30;
+    for (int t = 0; t < TRIALS; t++) {
+        auto start = std::chrono::steady_clock::now();
+        for (int r = 0; r < REPEATS; r++) {
+            size_t c = r & 63;
+            checksum += kernel(w.cts.data(), w.wts.data(), ENTRIES, w.candCt[c], w.candWt[c]);
+        }
+        double elapsed = std::chrono::duration<double>(
+            std::chrono::steady_clock::now() - start).count();
+        best = std::min(best, elapsed);
+    }
+    return best / REPEATS * 1e9;  // ns mỗi lần gọi
+}
+
+bool agrees(Kernel kernel, const Workload& w) {
+    for (size_t c = 0; c < w.candCt.size(); c++) {
+        for (size_t len : {ENTRIES, ENTRIES - 1, ENTRIES / 2 + 1, (size_t)3, (size_t)0}) {
+            size_t a = DominanceKernels::weaklyDominatedRunScalar(
+                w.cts.data(), w.wts.data(), len, w.candCt[c], w.candWt[c]);
+            size_t b = kernel(w.cts.data(), w.wts.data(), len, w.candCt[c], w.candWt[c]);
+            if (a != b) return false;
+        }
+    }
+    return true;
+}
+
+}  // namespace
+
+int main() {
+    std::mt19937 rng(1);
+    struct Path { const char* name; Kernel kernel; };
+    std::vector<Path> paths;
+    paths.push_back(Path{"scalar", DominanceKernels::weaklyDominatedRunScalar});
+#ifdef __SSE2__
+    paths.push_back(Path{"sse2", DominanceKernels::weaklyDominatedRunSSE2});
+#endif
+#ifdef __AVX2__
+    paths.push_back(Path{"avx2", DominanceKernels::weaklyDominatedRunAVX2});
+#endif
+
+    printf("%-10s", "run");
+    for (const Path& path : paths) printf("%14s", path.name);
+    for (size_t i = 1; i < paths.size(); i++) printf("%12s", paths[i].name);
+    printf("\n%-10s", "");
+    for (size_t i = 0; i < paths.size(); i++) printf("%14s", "ns/call");
+    for (size_t i = 1; i < paths.size(); i++) printf("%12s", "vs scalar");
+    printf("\n");
+
+    size_t checksum = 0;
+    bool ok = true;
+    for (size_t runLength : {(size_t)16, (size_t)128, (size_t)512, ENTRIES}) {
+        Workload w = makeWorkload(runLength, rng);
+        std::vector<double> ns;
+        for (const Path& path : paths) {
+            ok = ok && agrees(path.kernel, w);
+            ns.push_back(timeKernel(path.kernel, w, checksum));
+        }
+        printf("%-10zu", runLength);
+        for (double t : ns) printf("%14.1f", t);
+        for (size_t i = 1; i < ns.size(); i++) printf("%11.2fx", ns[0] / ns[i]);
+        printf("\n");
+    }
+    printf("%s (checksum %zu)\n", ok ? "all paths agree with scalar" : "MISMATCH", checksum);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,205 @@
+// Microbenchmark InsertionKernel: bestTruckPositionScalar vs bestTruckPositionAVX2
+// trên các instance 100 và 200 customer trong data/.
+//
+// Build (từ thư mục gốc repo, cần -mavx2 để có đường AVX2):
+//   g++ -std=c++17 -O2 -mavx2 -Isrc/header bench/insertion_kernel.cpp $(ls src/*.cpp | grep -v main.cpp) -o /tmp/bench_insertion -pthread
+// Chạy: /tmp/bench_insertion [data-dir]   (mặc định data)
+//
+// Với mỗi instance: decode một hoán vị ngẫu nhiên (seed cố định), lấy các
+// truck route của lời giải, chấm mọi customer vào mọi route bằng từng đường.
+// Thêm một lượt quét độ dài route: nối mọi truck route của instance 200
+// customer đầu tiên rồi cắt còn m vị trí, để thấy điểm hòa vốn của AVX2
+// (InsertionKernel::AVX2_MIN_POSITIONS). Kết quả hai đường được đối chiếu
+// trước khi đo; thời gian là min của TRIALS lượt.
+#include "InsertionKernel.h"
+#include "Decoder.h"
+#include "InputReader.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <random>
+#include <string>
+#include <vector>
+
+#ifndef __AVX2__
+int main() {
+    printf("Build with -mavx2 to compare the AVX2 and scalar paths.\n");
+    return 0;
+}
+#else
+
+namespace {
+
+const int TRIALS = 5;
+const double POSITIONS_PER_TRIAL = 2e6;  // số vị trí chấm mỗi lượt
+
+typedef BatchInsertion (*Kernel)(const TruckRouteBatch&, const TruckInsertionCandidate&);
+
+// Một truck route dạng SoA, dựng giống Decoder::refreshTruckCache
+struct RouteData {
+    std::vector<int> nodes;
+    std::vector<double> arrival;
+    std::vector<double> prevToNext;
+
+    RouteData(const Instance& inst, const std::vector<int>& customers) {
+        int m = customers.size();
+        nodes.assign(m + 2, 0);
+        std::copy(customers.begin(), customers.end(), nodes.begin() + 1);
+        double time = 0;
+        int prev = 0;
+        for (int c : customers) {
+            time += inst.getTruckTime(prev, c);
+            time += inst.customers[c - 1].serviceTimeTruck;
+            arrival.push_back(time);
+            prev = c;
+        }
+        for (int p = 0; p <= m; p++) {
+            prevToNext.push_back(inst.getTruckTime(nodes[p], nodes[p + 1]));
+        }
+    }
+
+    TruckRouteBatch batch() const {
+        return TruckRouteBatch{nodes.data(), arrival.data(), prevToNext.data(),
+                               (int)arrival.size()};
+    }
+};
+
+bool loadInstance(const std::string& path, Instance& inst) {
+    return InputReader::readInstance(path, inst) && inst.hasDistanceMatrix();
+}
+
+std::vector<std::vector<int>> decodedTruckRoutes(const Instance& inst) {
+    int n = inst.getNumCustomers();
+    std::vector<int> permutation(n);
+    for (int i = 0; i < n; i++) permutation[i] = i + 1;
+    std::mt19937 rng(1);
+    std::shuffle(permutation.begin(), permutation.end(), rng);
+
+    Decoder decoder(inst);
+    Solution solution;
+    decoder.decode(permutation, solution);
+
+    std::vector<std::vector<int>> routes;
+    for (const Route& route : solution.truckRoutes) {
+        if (!route.isEmpty()) routes.push_back(route.customers);
+    }
+    return routes;
+}
+
+// ns mỗi vị trí, min qua TRIALS lượt
+double timeKernel(Kernel kernel, const Instance& inst, const std::vector<RouteData>& routes,
+                  double& checksum) {
+    int n = inst.getNumCustomers();
+    long positionsPerPass = 0;
+    for (const RouteData& route : routes) positionsPerPass += (long)n * route.arrival.size();
+    int passes = std::max(1, (int)(POSITIONS_PER_TRIAL / positionsPerPass));
+
+    double best = 1e30;
+    for (int t = 0; t < TRIALS; t++) {
+        auto start = std::chrono::steady_clock::now();
+        for (int pass = 0; pass < passes; pass++) {
+            for (int c = 1; c <= n; c++) {
+                TruckInsertionCandidate cand = {inst.getTruckTimeRow(c),
+                                                inst.customers[c - 1].serviceTimeTruck};
+                for (const RouteData& route : routes) {
+                    BatchInsertion result = kernel(route.batch(), cand);
+                    checksum += result.cost + result.position;
+                }
+            }
+        }
+        double elapsed = std::chrono::duration<double>(
+            std::chrono::steady_clock::now() - start).count();
+        best = std::min(best, elapsed);
+    }
+    return best / ((double)passes * positionsPerPass) * 1e9;
+}
+
+int countMismatches(const Instance& inst, const std::vector<RouteData>& routes) {
+    int mismatches = 0;
+    for (int c = 1; c <= inst.getNumCustomers(); c++) {
+        TruckInsertionCandidate cand = {inst.getTruckTimeRow(c),
+                                        inst.customers[c - 1].serviceTimeTruck};
+        for (const RouteData& route : routes) {
+            BatchInsertion a = InsertionKernel::bestTruckPositionScalar(route.batch(), cand);
+            BatchInsertion b = InsertionKernel::bestTruckPositionAVX2(route.batch(), cand);
+            if (a.position != b.position || a.cost != b.cost) mismatches++;
+        }
+    }
+    return mismatches;
+}
+
+void report(const char* label, const Instance& inst, const std::vector<RouteData>& routes,
+            int& totalMismatches, double& checksum) {
+    long positions = 0;
+    for (const RouteData& route : routes) positions += route.arrival.size();
+    int mismatches = countMismatches(inst, routes);
+    totalMismatches += mismatches;
+
+    double scalar = timeKernel(InsertionKernel::bestTruckPositionScalar, inst, routes, checksum);
+    double avx2 = timeKernel(InsertionKernel::bestTruckPositionAVX2, inst, routes, checksum);
+    printf("%-16s %6zu %9.1f %12.2f %10.2f %8.2fx %10d\n", label, routes.size(),
+           (double)positions / routes.size(), scalar, avx2, scalar / avx2, mismatches);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    std::string dataDir = argc > 1 ? argv[1] : "data";
+
+    std::vector<std::string> files;
+    for (const auto& entry : std::filesystem::directory_iterator(dataDir)) {
+        std::string name = entry.path().filename().string();
+        if (name.rfind("100.", 0) == 0 || name.rfind("200.", 0) == 0) {
+            files.push_back(entry.path().string());
+        }
+    }
+    std::sort(files.begin(), files.end());
+    if (files.empty()) {
+        printf("No 100- or 200-customer instances in %s\n", dataDir.c_str());
+        return 1;
+    }
+
+    printf("%-16s %6s %9s %12s %10s %9s %10s\n", "instance", "routes", "pos/route",
+           "scalar ns/p", "avx2 ns/p", "speedup", "mismatch");
+
+    int totalMismatches = 0;
+    double checksum = 0;
+    std::string sweepFile;
+    for (const std::string& file : files) {
+        Instance inst;
+        if (!loadInstance(file, inst)) continue;
+        if (sweepFile.empty() && inst.getNumCustomers() == 200) sweepFile = file;
+
+        std::vector<RouteData> routes;
+        for (const auto& customers : decodedTruckRoutes(inst)) {
+            routes.push_back(RouteData(inst, customers));
+        }
+        std::string label = std::filesystem::path(file).filename().string();
+        report(label.c_str(), inst, routes, totalMismatches, checksum);
+    }
+
+    if (!sweepFile.empty()) {
+        Instance inst;
+        loadInstance(sweepFile, inst);
+        std::vector<int> all;
+        for (const auto& customers : decodedTruckRoutes(inst)) {
+            all.insert(all.end(), customers.begin(), customers.end());
+        }
+
+        printf("\nroute length sweep (%s, one route of m positions)\n", sweepFile.c_str());
+        for (int m : {8, 16, 24, 32, 64, 128}) {
+            if (m > (int)all.size()) break;
+            std::vector<int> prefix(all.begin(), all.begin() + m);
+            std::vector<RouteData> routes(1, RouteData(inst, prefix));
+            std::string label = "m=" + std::to_string(m);
+            report(label.c_str(), inst, routes, totalMismatches, checksum);
+        }
+    }
+
+    printf("\n%s (checksum %.6g)\n",
+           totalMismatches == 0 ? "AVX2 agrees with scalar" : "MISMATCH", checksum);
+    return totalMismatches == 0 ? 0 : 1;
+}
+
+#endif
@@ -0,0 +1,36 @@
+#include "AllocCounter.h"
+
+#ifdef ICAHGS_COUNT_ALLOCS
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace {
+std::atomic<uint64_t> allocationCount{0};
+
+void* countedAlloc(size_t size) {
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    if (size == 0) size = 1;
+    void* ptr = std::malloc(size);
+    if (!ptr) throw std::bad_alloc();
+    return ptr;
+}
+} // namespace
+
+void* operator new(size_t size) { return countedAlloc(size); }
+void* operator new[](size_t size) { return countedAlloc(size); }
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete[](void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, size_t) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { std::free(ptr); }
+
+bool AllocCounter::enabled() { return true; }
+uint64_t AllocCounter::count() { return allocationCount.load(std::memory_order_relaxed); }
+
+#else
+
+bool AllocCounter::enabled() { return false; }
+uint64_t AllocCounter::count() { return 0; }
+
+#endif
@@ -1,5 +1,6 @@
 // DataStructures.cpp
 #include "DataStructures.h"
+#include <algorithm>
 
 // Implementation of non-inline methods for DataStructures
 
@@ -7,4 +8,265 @@
 // This file ensures the translation unit is properly compiled
 
 // If you need to add any additional implementations in the future,
-// they can be added here rather than in the header file.
\ No newline at end of file
+// they can be added here rather than in the header file.
+
+bool Instance::buildDistanceMatrix(int maxMatrixNodes) {
+    int size = getNumCustomers() + 1;  // + depot
+
+    distanceMatrix.clear();
+    droneTimeMatrix.clear();
+    truckTimeMatrix.clear();
+    matrixSize = 0;
+
+    // Quá lớn → tính trực tiếp mỗi lần gọi
+    if (size > maxMatrixNodes) {
+        return false;
+    }
+
+    distanceMatrix.assign((size_t)size * size, 0.0);
+    droneTimeMatrix.assign((size_t)size * size, 0.0);
+    truckTimeMatrix.assign((size_t)size * size, 0.0);
+
+    for (int i = 0; i < size; i++) {
+        for (int j = 0; j < size; j++) {
+            if (i == j) continue;  // depot→depot, c→c = 0
+            double d = computeDistance(i, j);
+            distanceMatrix[(size_t)i * size + j] = d;
+            droneTimeMatrix[(size_t)i * size + j] = d / droneParams.cruiseSpeed;
+            truckTimeMatrix[(size_t)i * size + j] = d / truckParams.maxSpeed;
+        }
+    }
+
+    matrixSize = size;
+    return true;
+}
+
+void Instance::buildNeighborLists(int k) {
+    int n = getNumCustomers();
+    k = min(k, n - 1);
+    
+    nearestNeighbors.clear();
+    numNeighbors = max(k, 0);
+    if (numNeighbors == 0) return;
+    
+    nearestNeighbors.assign((size_t)(n + 1) * numNeighbors, 0);
+    vector<pair<double, int>> candidates;
+    candidates.reserve(n);
+    
+    for (int i = 1; i <= n; i++) {
+        candidates.clear();
+        for (int j = 1; j <= n; j++) {
+            if (j != i) candidates.push_back({getDistance(i, j), j});
+        }
+        partial_sort(candidates.begin(), candidates.begin() + numNeighbors,
+                     candidates.end());
+        for (int r = 0; r < numNeighbors; r++) {
+            nearestNeighbors[(size_t)i * numNeighbors + r] = candidates[r].second;
+        }
+    }
+}
+
+// === FlatSolution ===
+
+void FlatSolution::assign(const Solution& solution) {
+    customers.clear();
+    routes.clear();
+    numTrucks = solution.truckRoutes.size();
+    numDrones = solution.droneRoutes.size();
+    
+    auto append = [this](const Route& route, int vehicleType, int vehicleId, int tripId) {
+        RouteDescriptor d;
+        d.vehicleType = vehicleType;
+        d.vehicleId = vehicleId;
+        d.tripId = tripId;
+        d.offset = customers.size();
+        d.length = route.size();
+        d.completionTime = route.completionTime;
+        d.totalWaitingTime = route.totalWaitingTime;
+        routes.push_back(d);
+        customers.insert(customers.end(), route.customers.begin(), route.customers.end());
+    };
+    
+    for (int truckId = 0; truckId < numTrucks; truckId++) {
+        append(solution.truckRoutes[truckId], 0, truckId, -1);
+    }
+    for (int droneId = 0; droneId < numDrones; droneId++) {
+        const auto& trips = solution.droneRoutes[droneId];
+        for (size_t tripId = 0; tripId < trips.size(); tripId++) {
+            append(trips[tripId], 1, droneId, tripId);
+        }
+    }
+    
+    systemCompletionTime = solution.systemCompletionTime;
+    totalSampleWaitingTime = solution.totalSampleWaitingTime;
+    paretoRank = solution.paretoRank;
+    crowdingDistance = solution.crowdingDistance;
+    solutionHash = solution.solutionHash;
+}
+
+void FlatSolution::expandInto(Solution& solution) const {
+    // resize thay vì clear để giữ lại bộ nhớ của các route sẵn có
+    solution.truckRoutes.resize(numTrucks);
+    solution.droneRoutes.resize(numDrones);
+    for (int droneId = 0; droneId < numDrones; droneId++) {
+        RouteBufferPool::local().resizeTrips(solution.droneRoutes[droneId], numTrips(droneId));
+    }
+    
+    for (const auto& d : routes) {
+        Route& route = (d.vehicleType == 0) ? solution.truckRoutes[d.vehicleId]
+                                            : solution.droneRoutes[d.vehicleId][d.tripId];
+        // Truck route đủ chỗ cho mọi customer: về sau chuyển khách qua lại
+        // giữa các truck không phải cấp phát lại
+        if (d.vehicleType == 0 && route.customers.capacity() < customers.size()) {
+            route.customers.reserve(customers.size());
+        }
+        route.customers.assign(customers.begin() + d.offset,
+                               customers.begin() + d.offset + d.length);
+        route.completionTime = d.completionTime;
+        route.totalWaitingTime = d.totalWaitingTime;
+    }
+    
+    solution.systemCompletionTime = systemCompletionTime;
+    solution.totalSampleWaitingTime = totalSampleWaitingTime;
+    solution.paretoRank = paretoRank;
+    solution.crowdingDistance = crowdingDistance;
+    solution.solutionHash = solutionHash;
+}
+
+Solution FlatSolution::toSolution() const {
+    Solution solution;
+    expandInto(solution);
+    return solution;
+}
+
+void FlatSolution::droneTripRange(int droneId, int& first, int& last) const {
+    // Drone trips nằm sau numTrucks truck, sắp theo (vehicleId, tripId)
+    auto lo = lower_bound(routes.begin() + numTrucks, routes.end(), droneId,
+        [](const RouteDescriptor& d, int id) { return d.vehicleId < id; });
+    auto hi = lo;
+    while (hi != routes.end() && hi->vehicleId == droneId) ++hi;
+    first = lo - routes.begin();
+    last = hi - routes.begin();
+}
+
+// === RouteBufferPool ===
+
+RouteBufferPool& RouteBufferPool::local() {
+    static thread_local RouteBufferPool pool;
+    return pool;
+}
+
+void RouteBufferPool::resizeTrips(vector<Route>& trips, size_t count) {
+    while (trips.size() > count) {
+        buffers.push_back(std::move(trips.back().customers));
+        trips.pop_back();
+    }
+    while (trips.size() < count) {
+        addTrip(trips);
+    }
+}
+
+Route& RouteBufferPool::addTrip(vector<Route>& trips) {
+    trips.emplace_back();
+    Route& trip = trips.back();
+    if (!buffers.empty()) {
+        trip.customers = std::move(buffers.back());
+        trip.customers.clear();
+        buffers.pop_back();
+    }
+    return trip;
+}
+
+void RouteBufferPool::assign(Solution& target, const Solution& source) {
+    target.truckRoutes = source.truckRoutes;
+    target.droneRoutes.resize(source.droneRoutes.size());
+    for (size_t droneId = 0; droneId < source.droneRoutes.size(); droneId++) {
+        resizeTrips(target.droneRoutes[droneId], source.droneRoutes[droneId].size());
+        for (size_t tripId = 0; tripId < source.droneRoutes[droneId].size(); tripId++) {
+            target.droneRoutes[droneId][tripId] = source.droneRoutes[droneId][tripId];
+        }
+    }
+    target.systemCompletionTime = source.systemCompletionTime;
+    target.totalSampleWaitingTime = source.totalSampleWaitingTime;
+    target.paretoRank = source.paretoRank;
+    target.crowdingDistance = source.crowdingDistance;
+    target.solutionHash = source.solutionHash;
+}
+
+// === CustomerIndex ===
+
+void CustomerIndex::build(const Solution& solution, int numCustomers) {
+    locations.assign(numCustomers + 1, CustomerLocation());
+    
+    for (size_t truckId = 0; truckId < solution.truckRoutes.size(); truckId++) {
+        reindexRoute(solution, 0, truckId);
+    }
+    for (size_t droneId = 0; droneId < solution.droneRoutes.size(); droneId++) {
+        for (size_t tripId = 0; tripId < solution.droneRoutes[droneId].size(); tripId++) {
+            reindexRoute(solution, 1, droneId, tripId);
+        }
+    }
+}
+
+void CustomerIndex::reindexRoute(const Solution& solution, int vehicleType,
+                                 int vehicleId, int tripId) {
+    const Route& route = (vehicleType == 0) ? solution.truckRoutes[vehicleId]
+                                            : solution.droneRoutes[vehicleId][tripId];
+    for (int pos = 0; pos < route.size(); pos++) {
+        CustomerLocation& loc = locations[route.customers[pos]];
+        loc.vehicleType = vehicleType;
+        loc.vehicleId = vehicleId;
+        loc.tripId = (vehicleType == 0) ? -1 : tripId;
+        loc.position = pos;
+    }
+}
+
+// === SpeedProfile ===
+
+void SpeedProfile::compile(const vector<TimeInterval>& intervals, double maxSpeed) {
+    breakTimes.clear();
+    cumDist.clear();
+    speeds.clear();
+
+    vector<TimeInterval> sorted = intervals;
+    sort(sorted.begin(), sorted.end(),
+         [](const TimeInterval& a, const TimeInterval& b) {
+             return a.startTime < b.startTime;
+         });
+
+    // Ngoài mọi interval → dùng σ của interval cuối cùng (như getSpeedFactor cũ)
+    double outsideSigma = intervals.empty() ? 1.0 : intervals.back().sigma;
+
+    auto addSegment = [&](double start, double sigma) {
+        double speed = maxSpeed * sigma;
+        if (!breakTimes.empty() && speeds.back() == speed) return;  // gộp
+        double d = 0;
+        if (!breakTimes.empty()) {
+            d = cumDist.back() + speeds.back() * (start - breakTimes.back());
+        }
+        breakTimes.push_back(start);
+        cumDist.push_back(d);
+        speeds.push_back(speed);
+    };
+
+    double t = 0;
+    for (const auto& interval : sorted) {
+        if (interval.endTime <= t) continue;
+        if (interval.startTime > t) {
+            addSegment(t, outsideSigma);  // khoảng trống giữa các interval
+        }
+        addSegment(max(t, interval.startTime), interval.sigma);
+        t = interval.endTime;
+    }
+    addSegment(t, outsideSigma);  // sau interval cuối: không giới hạn
+}
+
+int SpeedProfile::segmentAtTime(double t) const {
+    int j = upper_bound(breakTimes.begin(), breakTimes.end(), t) - breakTimes.begin() - 1;
+    return max(j, 0);
+}
+
+int SpeedProfile::segmentAtDistance(double d) const {
+    int j = upper_bound(cumDist.begin(), cumDist.end(), d) - cumDist.begin() - 1;
+    return max(j, 0);
+}
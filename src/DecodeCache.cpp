@@ -0,0 +1,131 @@
+#include "DecodeCache.h"
+
+DecodeCache::DecodeCache(size_t capacity, int numCustomers, int numRoutes) {
+    configure(capacity, numCustomers, numRoutes);
+}
+
+void DecodeCache::configure(size_t newCapacity, int newNumCustomers, int newNumRoutes) {
+    capacity = newCapacity;
+    numCustomers = newNumCustomers;
+    numRoutes = newNumRoutes;
+    entries.resize(capacity);
+    for (Entry& entry : entries) {
+        entry.permutation.reserve(numCustomers);
+        entry.result.customers.reserve(numCustomers);
+        entry.result.routes.reserve(numRoutes);
+    }
+    numEntries = 0;
+
+    // Bảng index tải ≤ 50%
+    size_t indexSize = 1;
+    while (indexSize < 2 * capacity) indexSize *= 2;
+    index.assign(indexSize, -1);
+    mask = indexSize - 1;
+
+    hand = 0;
+    hitCount = 0;
+    missCount = 0;
+}
+
+void DecodeCache::clear() {
+    configure(capacity, numCustomers, numRoutes);
+}
+
+uint64_t DecodeCache::hashPermutation(const std::vector<int>& permutation) {
+    // Rolling hash đa thức, trộn lại ở cuối (splitmix64) cho bit thấp đều
+    uint64_t h = permutation.size();
+    for (int gene : permutation) {
+        h = h * 0x100000001B3ULL + static_cast<uint32_t>(gene);
+    }
+    h ^= h >> 30;
+    h *= 0xBF58476D1CE4E5B9ULL;
+    h ^= h >> 27;
+    h *= 0x94D049BB133111EBULL;
+    h ^= h >> 31;
+    return h;
+}
+
+int DecodeCache::lookup(uint64_t key, const std::vector<int>& permutation,
+                        size_t& slot) const {
+    for (slot = home(key); index[slot] != -1; slot = (slot + 1) & mask) {
+        const Entry& entry = entries[index[slot]];
+        if (entry.key == key && entry.permutation == permutation) {
+            return index[slot];
+        }
+    }
+    return -1;
+}
+
+const DecodeCache::Entry* DecodeCache::find(const std::vector<int>& permutation) {
+    if (!enabled()) return nullptr;
+
+    size_t slot;
+    int pos = lookup(hashPermutation(permutation), permutation, slot);
+    if (pos < 0) {
+        missCount++;
+        return nullptr;
+    }
+    hitCount++;
+    entries[pos].referenced = true;
+    return &entries[pos];
+}
+
+void DecodeCache::insert(const std::vector<int>& permutation, uint64_t decodedHash,
+                         const Solution* improved) {
+    if (!enabled()) return;
+
+    uint64_t key = hashPermutation(permutation);
+    size_t slot;
+    int pos = lookup(key, permutation, slot);
+    if (pos < 0) {
+        if (numEntries < capacity) {
+            pos = numEntries++;
+        } else {
+            pos = evict();
+            lookup(key, permutation, slot);  // xóa có thể dời các ô trong index
+        }
+        index[slot] = pos;
+
+        Entry& entry = entries[pos];
+        entry.key = key;
+        entry.permutation = permutation;  // buffer cấp sẵn / của entry bị thay
+        entry.improved = false;
+    }
+
+    Entry& entry = entries[pos];
+    entry.decodedHash = decodedHash;
+    entry.referenced = true;
+    if (improved) {
+        entry.result.assign(*improved);
+        entry.improved = true;
+    }
+}
+
+// CLOCK: bỏ qua (và xóa bit) các entry vừa được dùng, lấy entry đầu tiên không
+size_t DecodeCache::evict() {
+    while (entries[hand].referenced) {
+        entries[hand].referenced = false;
+        hand = (hand + 1) % numEntries;
+    }
+    size_t victim = hand;
+    hand = (hand + 1) % numEntries;
+
+    size_t slot;
+    lookup(entries[victim].key, entries[victim].permutation, slot);
+    removeFromIndex(slot);
+    return victim;
+}
+
+// Xóa kiểu backward shift: dời các ô phía sau về lại gần vị trí home của chúng
+void DecodeCache::removeFromIndex(size_t slot) {
+    size_t hole = slot;
+    for (size_t next = (hole + 1) & mask; index[next] != -1; next = (next + 1) & mask) {
+        size_t want = home(entries[index[next]].key);
+        // Ô next có thể lấp vào hole nếu home của nó không nằm trong (hole, next]
+        if (((next - want) & mask) >= ((next - hole) & mask)) {
+            index[hole] = index[next];
+            hole = next;
+        }
+    }
+    index[hole] = -1;
+}
@@ -1,63 +1,266 @@
 #include "Decoder.h"
+#include "ScratchArena.h"
 #include <algorithm>
 #include <limits>
 
-Solution Decoder::decode(const std::vector<int>& permutation) {
-    Solution solution;
-    std::vector<bool> servedCustomers(instance.getNumCustomers() + 1, false);
-    
-    // Initialize routes
-    solution.truckRoutes.resize(instance.numTrucks);
-    solution.droneRoutes.resize(instance.numDrones);
-    
-    // Process each customer in permutation order
-    for (int custId : permutation) {
-        if (servedCustomers[custId]) continue; // Bỏ qua nếu đã phục vụ
+// Sai số cho phép khi loại sớm bằng cận dưới (cận dựa trên bất đẳng thức tam
+// giác, có thể lệch vài ulp); trường hợp sát biên vẫn được kiểm tra chính xác
+static const double DRONE_PRUNE_TOLERANCE = 1e-9;
 
-        // Evaluate the current partial solution before finding the best insertion
-        evaluator.evaluate(solution);
+Decoder::Decoder(const Instance& inst, const DecoderParams& params)
+    : instance(inst), params(params), evaluator(inst),
+      hasher(inst.getNumCustomers(), inst.numTrucks, inst.numDrones) {
+    buildDroneTables();
+}
 
+void Decoder::buildDroneTables() {
+    int n = instance.getNumCustomers();
+    const DroneParams& drone = instance.droneParams;
+    double energyLimit = drone.maxEnergy * (1 + DRONE_PRUNE_TOLERANCE);
+    
+    singleTripCost.assign(n + 1, INF);
+    canFly.assign(n + 1, 0);
+    minDroneDemand = INF;
+    
+    for (int custId = 1; custId <= n; custId++) {
         const Customer& cust = instance.customers[custId - 1];
+        if (cust.isStaffOnly || cust.demand > drone.maxCapacity) continue;
         
-        InsertionMove bestMove;
+        // Công thức như computeDroneInsertionDelta với trip rỗng
+        double time = 0 + instance.getDroneFlightTime(0, custId);
+        time += cust.serviceTimeDrone;
+        double completionTime = time + instance.getDroneFlightTime(custId, 0);
+        double energy = (drone.beta * (cust.demand / 2) + drone.gamma) * completionTime;
         
-        if (cust.isStaffOnly) {
-            bestMove = findBestTruckInsertionIncremental(custId, solution);
-        } else {
-            InsertionMove truckMove = findBestTruckInsertionIncremental(custId, solution);
-            InsertionMove droneMove = findBestDroneInsertionIncremental(custId, solution);
-            
-            bestMove = (truckMove.cost < droneMove.cost) ? truckMove : droneMove;
+        if (energy <= drone.maxEnergy) {
+            singleTripCost[custId] = 0.5 * completionTime + 0.5 * time;
         }
-        
-        // Apply best insertion
-        if (bestMove.routeType == 0) {
-            // Insert into truck route
-            auto& route = solution.truckRoutes[bestMove.routeId];
-            route.customers.insert(route.customers.begin() + bestMove.position, 
-                                 custId);
-        } else if (bestMove.routeType == 1) {
-            // Insert into drone route
-            auto& droneTrips = solution.droneRoutes[bestMove.routeId];
-            
-            if (bestMove.position >= droneTrips.size()) { // Sửa logic: dùng position thay vì routeId
-                // Create new trip
-                Route newTrip;
-                newTrip.customers.push_back(custId);
-                droneTrips.push_back(newTrip);
-            } else {
-                // Insert into existing trip
-                droneTrips[bestMove.position].customers.push_back(custId);
-            }
+        if (energy <= energyLimit) {
+            canFly[custId] = 1;
+            minDroneDemand = std::min(minDroneDemand, cust.demand);
+        }
+    }
+}
+
+// Không evaluate lời giải dở dang trước mỗi lần chèn nữa: việc chọn vị trí chỉ
+// đọc route + cache của route, nên kết quả giống hệt bản cũ. Chỉ route nhận
+// customer được cập nhật cache; evaluator chạy đầy đủ một lần ở cuối.
+Solution Decoder::decode(const std::vector<int>& permutation) {
+    Solution solution;
+    decode(permutation, solution);
+    return solution;
+}
+
+void Decoder::decode(const std::vector<int>& permutation, Solution& solution) {
+    // Split không cắt được (vd. không đủ truck cho customer staff-only) → chèn
+    if (params.mode == DecoderParams::SPLIT && decodeSplit(permutation, solution)) {
+        return;
+    }
+    decodeInsertion(permutation, solution, false);
+}
+
+void Decoder::setReference(const std::vector<int>& permutation) {
+    if (params.mode == DecoderParams::SPLIT || params.checkpointInterval <= 0 ||
+        params.regretK >= 2) return;
+    if (numCheckpoints > 0 && permutation == checkpointPermutation) return;
+    decodeInsertion(permutation, referenceSolution, true);
+}
+
+void Decoder::decodeInsertion(const std::vector<int>& permutation, Solution& solution,
+                              bool record) {
+    if (params.regretK >= 2) {
+        decodeRegret(permutation, solution);
+        return;
+    }
+    
+    ScratchArena& arena = ScratchArena::local();
+    ScratchArena::Scope scope(arena);
+    
+    int n = instance.getNumCustomers();
+    bool* servedCustomers = arena.allocate<bool>(n + 1);
+    std::fill(servedCustomers, servedCustomers + n + 1, false);
+    
+    // Tiếp tục từ checkpoint của hoán vị tham chiếu nếu chung prefix
+    int start = 0;
+    if (record) {
+        checkpointPermutation = permutation;
+        numCheckpoints = 0;
+    } else {
+        start = restoreCheckpoint(permutation, solution);
+    }
+    for (int p = 0; p < start; p++) {
+        servedCustomers[permutation[p]] = true;
+    }
+    if (start == 0) {
+        resetSolution(solution);
+    }
+    
+    // Process each customer in permutation order
+    int interval = record ? params.checkpointInterval : 0;
+    for (int p = start; p < (int)permutation.size(); p++) {
+        int custId = permutation[p];
+        if (!servedCustomers[custId]) { // Bỏ qua nếu đã phục vụ
+            insertCustomer(custId, solution);
+            servedCustomers[custId] = true; // Đánh dấu đã phục vụ
         }
         
-        servedCustomers[custId] = true; // Đánh dấu đã phục vụ
+        if (interval > 0 && (p + 1) % interval == 0) {
+            saveCheckpoint(p + 1, solution);
+        }
     }
     
     // Evaluate final solution
     evaluator.evaluate(solution);
+}
+
+// Lời giải rỗng, giữ lại bộ nhớ của route cũ
+void Decoder::resetSolution(Solution& solution) {
+    solution.truckRoutes.resize(instance.numTrucks);
+    for (auto& route : solution.truckRoutes) {
+        route.clear();
+    }
+    solution.droneRoutes.resize(instance.numDrones);
+    for (auto& trips : solution.droneRoutes) {
+        RouteBufferPool::local().resizeTrips(trips, 0);
+    }
+    solution.systemCompletionTime = INF;
+    solution.totalSampleWaitingTime = INF;
+    solution.paretoRank = 0;
+    solution.crowdingDistance = 0;
+    solution.solutionHash = 0;
+    resetRouteCaches();
+}
+
+// ==================== CHECKPOINTS ====================
+
+// Trạng thái decode chỉ phụ thuộc prefix đã xử lý của hoán vị, nên hoán vị
+// chung prefix với checkpointPermutation có thể tiếp tục từ checkpoint cuối
+// cùng nằm trong prefix chung. Trả về số phần tử đã xử lý (0 = decode từ đầu).
+int Decoder::restoreCheckpoint(const std::vector<int>& permutation, Solution& solution) {
+    if (numCheckpoints == 0) return 0;
+    
+    size_t common = 0;
+    size_t limit = std::min(permutation.size(), checkpointPermutation.size());
+    while (common < limit && permutation[common] == checkpointPermutation[common]) {
+        common++;
+    }
     
-    return solution;
+    // Checkpoint cuối cùng có position <= common
+    size_t last = numCheckpoints;
+    while (last > 0 && checkpoints[last - 1].position > (int)common) {
+        last--;
+    }
+    if (last == 0) return 0;
+    
+    // Dựng lại route; cache của truck route tính lại từ route nên giống hệt
+    const DecodeCheckpoint& checkpoint = checkpoints[last - 1];
+    const int* customers = checkpoint.customers.data();
+    const int* lengths = checkpoint.routeLengths.data();
+    
+    resetRouteCaches();
+    solution.truckRoutes.resize(instance.numTrucks);
+    for (int truckId = 0; truckId < instance.numTrucks; truckId++) {
+        Route& route = solution.truckRoutes[truckId];
+        route.clear();
+        route.customers.assign(customers, customers + *lengths);
+        customers += *lengths++;
+        refreshTruckCache(route, truckId);
+    }
+    solution.droneRoutes.resize(instance.numDrones);
+    for (int droneId = 0; droneId < instance.numDrones; droneId++) {
+        auto& trips = solution.droneRoutes[droneId];
+        RouteBufferPool::local().resizeTrips(trips, *lengths++);
+        for (size_t tripId = 0; tripId < trips.size(); tripId++) {
+            Route& trip = trips[tripId];
+            trip.clear();
+            trip.customers.assign(customers, customers + *lengths);
+            customers += *lengths++;
+            for (int custId : trip.customers) {
+                appendDroneCache(droneId, tripId, custId);
+            }
+        }
+    }
+    
+    solution.systemCompletionTime = INF;
+    solution.totalSampleWaitingTime = INF;
+    solution.paretoRank = 0;
+    solution.crowdingDistance = 0;
+    solution.solutionHash = checkpoint.solutionHash;
+    return checkpoint.position;
+}
+
+// Chép phẳng mọi route: [độ dài truck...] rồi mỗi drone [số trip, độ dài trip...]
+void Decoder::saveCheckpoint(int position, const Solution& solution) {
+    if (numCheckpoints == checkpoints.size()) checkpoints.emplace_back();
+    DecodeCheckpoint& checkpoint = checkpoints[numCheckpoints++];
+    checkpoint.position = position;
+    checkpoint.solutionHash = solution.solutionHash;
+    checkpoint.customers.clear();
+    checkpoint.routeLengths.clear();
+    
+    for (const auto& route : solution.truckRoutes) {
+        checkpoint.customers.insert(checkpoint.customers.end(),
+                                    route.customers.begin(), route.customers.end());
+        checkpoint.routeLengths.push_back(route.size());
+    }
+    for (const auto& trips : solution.droneRoutes) {
+        checkpoint.routeLengths.push_back(trips.size());
+        for (const auto& trip : trips) {
+            checkpoint.customers.insert(checkpoint.customers.end(),
+                                        trip.customers.begin(), trip.customers.end());
+            checkpoint.routeLengths.push_back(trip.size());
+        }
+    }
+}
+
+// Chọn vị trí chèn tốt nhất cho custId và áp dụng (kèm hash + cache)
+void Decoder::insertCustomer(int custId, Solution& solution) {
+    const Customer& cust = instance.customers[custId - 1];
+    
+    InsertionMove bestMove;
+    
+    if (cust.isStaffOnly) {
+        // Must use truck
+        bestMove = findBestTruckInsertionIncremental(custId, solution);
+    } else {
+        // Try both
+        InsertionMove truckMove = findBestTruckInsertionIncremental(custId, solution);
+        InsertionMove droneMove = findBestDroneInsertionIncremental(custId);
+        
+        bestMove = (truckMove.cost < droneMove.cost) ? truckMove : droneMove;
+    }
+    
+    applyInsertion(custId, bestMove, solution);
+}
+
+void Decoder::applyInsertion(int custId, const InsertionMove& bestMove, Solution& solution) {
+    if (bestMove.routeType == 0) {
+        // Insert into truck route
+        auto& route = solution.truckRoutes[bestMove.routeId];
+        int prev = (bestMove.position > 0) ? route.customers[bestMove.position - 1] : 0;
+        int next = (bestMove.position < route.size()) ? route.customers[bestMove.position] : 0;
+        solution.solutionHash ^= hasher.linkDelta(
+            SolutionHasher::truckRouteKey(bestMove.routeId), prev, custId, next);
+        route.customers.insert(route.customers.begin() + bestMove.position, custId);
+        refreshTruckCache(route, bestMove.routeId);
+    } else if (bestMove.routeType == 1) {
+        // Insert into drone route
+        auto& droneTrips = solution.droneRoutes[bestMove.routeId];
+        uint64_t routeKey = SolutionHasher::droneRouteKey(bestMove.routeId, bestMove.position);
+        
+        if (bestMove.position >= (int)droneTrips.size()) {
+            // Create new trip
+            Route& newTrip = RouteBufferPool::local().addTrip(droneTrips);
+            newTrip.customers.push_back(custId);
+            solution.solutionHash ^= hasher.linkDelta(routeKey, 0, custId, 0);
+        } else {
+            // Insert into existing trip
+            auto& trip = droneTrips[bestMove.position];
+            solution.solutionHash ^= hasher.linkDelta(routeKey, trip.customers.back(), custId, 0);
+            trip.customers.push_back(custId);
+        }
+        appendDroneCache(bestMove.routeId, bestMove.position, custId);
+    }
 }
 
 Decoder::InsertionMove Decoder::findBestTruckInsertionIncremental(
@@ -70,17 +273,49 @@ Decoder::InsertionMove Decoder::findBestTruckInsertionIncremental(
     
     // Thử tất cả trucks và positions
     for (int truckId = 0; truckId < instance.numTrucks; truckId++) {
-        auto& route = solution.truckRoutes[truckId];
+        InsertionMove move = findBestTruckPosition(custId, truckId, solution);
+        if (move.cost < bestMove.cost) {
+            bestMove = move;
+        }
+    }
+    
+    return bestMove;
+}
+
+Decoder::InsertionMove Decoder::findBestTruckPosition(int custId, int truckId,
+                                                      Solution& solution) {
+    InsertionMove bestMove;
+    bestMove.routeType = 0;
+    bestMove.cost = INF;
+    
+    auto& route = solution.truckRoutes[truckId];
+    if (!route.isEmpty() && instance.hasDistanceMatrix()) {
+        // Vị trí 0 có công thức riêng; 1..m chấm theo lô trên dữ liệu SoA
+        bestMove.cost = computeTruckInsertionDelta(solution, custId, truckId, 0);
+        bestMove.routeId = truckId;
+        bestMove.position = 0;
         
-        for (size_t pos = 0; pos <= route.customers.size(); pos++) {
-            // ⭐ Tính delta cost thay vì evaluate toàn bộ
-            double deltaCost = computeTruckInsertionDelta(solution, custId, truckId, pos);
-            
-            if (deltaCost < bestMove.cost) {
-                bestMove.cost = deltaCost;
-                bestMove.routeId = truckId;
-                bestMove.position = pos;
-            }
+        const TruckRouteCache& cache = truckCaches[truckId];
+        TruckRouteBatch batch = {cache.nodes.data(), cache.arrival.data(),
+                                 cache.prevToNext.data(), route.size()};
+        TruckInsertionCandidate cand = {instance.getTruckTimeRow(custId),
+                                        instance.customers[custId - 1].serviceTimeTruck};
+        BatchInsertion rest = InsertionKernel::bestTruckPosition(batch, cand);
+        if (rest.cost < bestMove.cost) {
+            bestMove.cost = rest.cost;
+            bestMove.position = rest.position;
+        }
+        return bestMove;
+    }
+    
+    for (size_t pos = 0; pos <= route.customers.size(); pos++) {
+        // ⭐ Tính delta cost thay vì evaluate toàn bộ
+        double deltaCost = computeTruckInsertionDelta(solution, custId, truckId, pos);
+        
+        if (deltaCost < bestMove.cost) {
+            bestMove.cost = deltaCost;
+            bestMove.routeId = truckId;
+            bestMove.position = pos;
         }
     }
     
@@ -89,55 +324,57 @@ Decoder::InsertionMove Decoder::findBestTruckInsertionIncremental(
 
 
 
-Decoder::InsertionMove Decoder::findBestDroneInsertionIncremental(
-    int custId,
-    Solution& solution) {
+Decoder::InsertionMove Decoder::findBestDroneInsertionIncremental(int custId) {
     
     InsertionMove bestMove;
     bestMove.routeType = 1;
     bestMove.cost = INF;
     
-    const Customer& cust = instance.customers[custId - 1];
-    
     for (int droneId = 0; droneId < instance.numDrones; droneId++) {
-        auto& trips = solution.droneRoutes[droneId];
-        
-        // ========== Option 1: Add to existing trip ==========
-        for (size_t tripId = 0; tripId < trips.size(); tripId++) {
-            // Check capacity
-            double currentLoad = 0;
-            for (int c : trips[tripId].customers) {
-                currentLoad += instance.customers[c - 1].demand;
-            }
-            
-            if (currentLoad + cust.demand > instance.droneParams.maxCapacity) {
-                continue;  // Skip
-            }
-            
-            // Tính delta cost
-            double deltaCost = computeDroneInsertionDelta(
-                solution, custId, droneId, tripId, false
-            );
-            
-            if (deltaCost < bestMove.cost) {
-                bestMove.cost = deltaCost;
-                bestMove.routeId = droneId;
-                bestMove.position = tripId;
-            }
+        InsertionMove move = findBestDroneTrip(custId, droneId);
+        if (move.cost < bestMove.cost) {
+            bestMove = move;
+        }
+    }
+    
+    return bestMove;
+}
+
+Decoder::InsertionMove Decoder::findBestDroneTrip(int custId, int droneId) {
+    InsertionMove bestMove;
+    bestMove.routeType = 1;
+    bestMove.cost = INF;
+    
+    // Customer quá nặng / quá xa cho cả trip riêng → không cần thử trip nào
+    if (!canFly[custId]) return bestMove;
+    
+    const Customer& cust = instance.customers[custId - 1];
+    const auto& trips = droneCaches[droneId];
+    
+    // ========== Option 1: Add to existing trip ==========
+    for (size_t tripId = 0; tripId < trips.size(); tripId++) {
+        const DroneTripCache& trip = trips[tripId];
+        if (trip.closed ||
+            trip.load + cust.demand > instance.droneParams.maxCapacity) {
+            continue;  // Skip
         }
         
-        // ========== Option 2: Create new trip ==========
-        double deltaCost = computeDroneInsertionDelta(
-            solution, custId, droneId, trips.size(), true
-        );
+        double deltaCost = computeDroneInsertionDelta(trip, custId);
         
         if (deltaCost < bestMove.cost) {
             bestMove.cost = deltaCost;
             bestMove.routeId = droneId;
-            bestMove.position = trips.size();
+            bestMove.position = tripId;
         }
     }
     
+    // ========== Option 2: Create new trip ==========
+    if (singleTripCost[custId] < bestMove.cost) {
+        bestMove.cost = singleTripCost[custId];
+        bestMove.routeId = droneId;
+        bestMove.position = trips.size();
+    }
+    
     return bestMove;
 }
 
@@ -159,62 +396,15 @@ double Decoder::evaluateInsertionCost(const Solution& before,
 // ==================== INCREMENTAL DECODER ====================
 
 Solution Decoder::decodeIncremental(const std::vector<int>& permutation) {
-    Solution solution;
-    solution.truckRoutes.resize(instance.numTrucks);
-    solution.droneRoutes.resize(instance.numDrones);
-    
-    // Initialize với objectives = 0
-    solution.systemCompletionTime = 0;
-    solution.totalSampleWaitingTime = 0;
-    
-    std::vector<bool> servedCustomers(instance.getNumCustomers() + 1, false);
-    
-    for (int custId : permutation) {
-        if (servedCustomers[custId]) continue;
-        
-        const Customer& cust = instance.customers[custId - 1];
-        
-        InsertionMove bestMove;
-        
-        if (cust.isStaffOnly) {
-            // Must use truck
-            bestMove = findBestTruckInsertionIncremental(custId, solution);
-        } else {
-            // Try both
-            InsertionMove truckMove = findBestTruckInsertionIncremental(custId, solution);
-            InsertionMove droneMove = findBestDroneInsertionIncremental(custId, solution);
-            
-            bestMove = (truckMove.cost < droneMove.cost) ? truckMove : droneMove;
-        }
-        
-        // Apply move
-        if (bestMove.routeType == 0) {
-            // Truck
-            solution.truckRoutes[bestMove.routeId].customers.insert(
-                solution.truckRoutes[bestMove.routeId].customers.begin() + bestMove.position,
-                custId
-            );
-        } else {
-            // Drone
-            if (bestMove.position < (int)solution.droneRoutes[bestMove.routeId].size()) {
-                // Existing trip
-                solution.droneRoutes[bestMove.routeId][bestMove.position].customers.push_back(custId);
-            } else {
-                // New trip
-                Route newTrip;
-                newTrip.customers.push_back(custId);
-                solution.droneRoutes[bestMove.routeId].push_back(newTrip);
-            }
-        }
-        
-        servedCustomers[custId] = true;
-    }
-    
-    // ⭐ Final evaluation một lần duy nhất
-    evaluator.evaluate(solution);
-    
-    return solution;
+    // decode() đã không còn evaluate từng bước → hai chế độ trùng nhau
+    return decode(permutation);
 }
+
+// Chèn custId vào vị trí position của truck route, dùng cache của route:
+//   δ  = d(prev,c)/v + s_c + d(c,next)/v - d(prev,next)/v  (dời mọi customer phía sau)
+//   ΔCT = δ
+//   ΔWT = A'_p + (m - p)·δ   (p ≥ 1),   A_0 + m·δ   (p = 0, c_0 bắt đầu bị tính chờ)
+// → O(1) mỗi vị trí thay vì copy + duyệt lại route hai lần.
 double Decoder::computeTruckInsertionDelta(
     const Solution& current,
     int custId,
@@ -222,225 +412,411 @@ double Decoder::computeTruckInsertionDelta(
     int position) {
     
     const auto& route = current.truckRoutes[truckId];
+    const TruckRouteCache& cache = truckCaches[truckId];
     const Customer& newCust = instance.customers[custId - 1];
     
-    // ========== Tính OLD COST (trước khi thêm) ==========
-    double oldCompletionTime = 0;
-    double oldWaitingTime = 0;
+    int m = route.size();
+    double deltaCT, deltaWT;
     
-    if (!route.customers.empty()) {
-        // Route đã có customers
-        double currentTime = 0;
-        
-        // Depot → First customer
-        double distance = instance.getDistance(0, route.customers[0]);
-        double travelTime = distance / instance.truckParams.maxSpeed;
-        currentTime += travelTime;
+    if (m == 0) {
+        // Route rỗng: depot → cust → depot, customer đầu không tính chờ
+        deltaCT = instance.getTruckTime(0, custId) + newCust.serviceTimeTruck +
+                  instance.getTruckTime(custId, 0);
+        deltaWT = 0;
+    } else {
+        int prev = (position > 0) ? route.customers[position - 1] : 0;
+        int next = (position < m) ? route.customers[position] : 0;
         
-        // Service first customer
-        currentTime += instance.customers[route.customers[0] - 1].serviceTimeTruck;
+        double toNew = instance.getTruckTime(prev, custId);
+        double shift = toNew + newCust.serviceTimeTruck +
+                       instance.getTruckTime(custId, next) -
+                       instance.getTruckTime(prev, next);
+        int downstream = m - position;
         
-        // Traverse route
-        for (size_t i = 1; i < route.customers.size(); i++) {
-            int prev = route.customers[i-1];
-            int curr = route.customers[i];
-            
-            distance = instance.getDistance(prev, curr);
-            travelTime = distance / instance.truckParams.maxSpeed;
-            currentTime += travelTime;
-            
-            // Service
-            currentTime += instance.customers[curr - 1].serviceTimeTruck;
-            
-            // Waiting time
-            oldWaitingTime += currentTime;
+        deltaCT = shift;
+        if (position == 0) {
+            deltaWT = cache.arrival[0] + downstream * shift;
+        } else {
+            double newArrival = cache.arrival[position - 1] + toNew + newCust.serviceTimeTruck;
+            deltaWT = newArrival + downstream * shift;
         }
-        
-        // Return to depot
-        distance = instance.getDistance(route.customers.back(), 0);
-        travelTime = distance / instance.truckParams.maxSpeed;
-        currentTime += travelTime;
-        
-        oldCompletionTime = currentTime;
     }
     
-    // ========== Tính NEW COST (sau khi thêm) ==========
-    double newCompletionTime = 0;
-    double newWaitingTime = 0;
-    
-    // Tạo route tạm thời
-    std::vector<int> newRoute = route.customers;
-    newRoute.insert(newRoute.begin() + position, custId);
-    
-    double currentTime = 0;
+    // Weighted sum (có thể điều chỉnh weights)
+    double deltaCost = 0.5 * deltaCT + 0.5 * deltaWT;
     
-    // Depot → First customer
-    double distance = instance.getDistance(0, newRoute[0]);
-    double travelTime = distance / instance.truckParams.maxSpeed;
-    currentTime += travelTime;
+    return deltaCost;
+}
+
+void Decoder::resetRouteCaches() {
+    truckCaches.resize(instance.numTrucks);
+    for (auto& cache : truckCaches) {
+        cache.arrival.clear();
+        cache.nodes.clear();
+        cache.prevToNext.clear();
+    }
+    droneCaches.resize(instance.numDrones);
+    for (auto& trips : droneCaches) {
+        trips.clear();
+    }
+}
+
+// Tính lại cache cho một truck route (chỉ gọi cho route vừa nhận customer)
+void Decoder::refreshTruckCache(const Route& route, int truckId) {
+    TruckRouteCache& cache = truckCaches[truckId];
     
-    // Service first
-    currentTime += instance.customers[newRoute[0] - 1].serviceTimeTruck;
+    cache.arrival.resize(route.size());
     
-    // Traverse
-    for (size_t i = 1; i < newRoute.size(); i++) {
-        int prev = newRoute[i-1];
-        int curr = newRoute[i];
-        
-        distance = instance.getDistance(prev, curr);
-        travelTime = distance / instance.truckParams.maxSpeed;
-        currentTime += travelTime;
-        
-        // Service
-        currentTime += instance.customers[curr - 1].serviceTimeTruck;
+    double currentTime = 0;
+    int prevNode = 0;
+    for (int i = 0; i < route.size(); i++) {
+        int custId = route.customers[i];
+        currentTime += instance.getTruckTime(prevNode, custId);
+        currentTime += instance.customers[custId - 1].serviceTimeTruck;
         
-        // Waiting
-        newWaitingTime += currentTime;
+        cache.arrival[i] = currentTime;
+        prevNode = custId;
     }
     
-    // Return
-    distance = instance.getDistance(newRoute.back(), 0);
-    travelTime = distance / instance.truckParams.maxSpeed;
-    currentTime += travelTime;
+    int m = route.size();
+    cache.nodes.resize(m + 2);
+    cache.nodes[0] = 0;
+    std::copy(route.customers.begin(), route.customers.end(), cache.nodes.begin() + 1);
+    cache.nodes[m + 1] = 0;
+    cache.prevToNext.resize(m + 1);
+    for (int p = 0; p <= m; p++) {
+        cache.prevToNext[p] = instance.getTruckTime(cache.nodes[p], cache.nodes[p + 1]);
+    }
+}
+// Nối custId vào cuối trip: cùng thứ tự phép tính như khi duyệt lại cả trip
+double Decoder::computeDroneInsertionDelta(const DroneTripCache& trip, int custId) {
+    const Customer& newCust = instance.customers[custId - 1];
     
-    newCompletionTime = currentTime;
+    double time = trip.time + instance.getDroneFlightTime(trip.last, custId);
+    time += newCust.serviceTimeDrone;
+    double newWaitingTime = trip.waiting + time;
+    double newCompletionTime = time + instance.getDroneFlightTime(custId, 0);
     
-    // ========== DELTA COST ==========
-    double deltaCT = newCompletionTime - oldCompletionTime;
-    double deltaWT = newWaitingTime - oldWaitingTime;
+    // Power = beta * load + gamma
+    double load = trip.load + newCust.demand;
+    double avgPower = instance.droneParams.beta * (load / 2) + 
+                     instance.droneParams.gamma;
+    if (avgPower * newCompletionTime > instance.droneParams.maxEnergy) {
+        return INF;  // Infeasible
+    }
     
-    // Weighted sum (có thể điều chỉnh weights)
-    double deltaCost = 0.5 * deltaCT + 0.5 * deltaWT;
+    double deltaCT = newCompletionTime - trip.completionTime;
+    double deltaWT = newWaitingTime - trip.waiting;
     
-    return deltaCost;
+    return 0.5 * deltaCT + 0.5 * deltaWT;
 }
-double Decoder::computeDroneInsertionDelta(
-    const Solution& current,
-    int custId,
-    int droneId,
-    int tripId,
-    bool newTrip) {
-    
-    const Customer& newCust = instance.customers[custId - 1];
-    
-    // ========== OLD COST ==========
-    double oldCompletionTime = 0;
-    double oldWaitingTime = 0;
+
+// Cập nhật cache sau khi custId được nối vào cuối trip (tripId == số trip → trip mới)
+void Decoder::appendDroneCache(int droneId, int tripId, int custId) {
+    auto& trips = droneCaches[droneId];
+    if (tripId == (int)trips.size()) {
+        trips.push_back(DroneTripCache{0, 0, 0, 0, 0, 0, false});
+    }
+    DroneTripCache& trip = trips[tripId];
+    const Customer& cust = instance.customers[custId - 1];
+    const DroneParams& drone = instance.droneParams;
+    
+    trip.load += cust.demand;
+    trip.time += instance.getDroneFlightTime(trip.last, custId);
+    trip.time += cust.serviceTimeDrone;
+    trip.waiting += trip.time;
+    trip.completionTime = trip.time + instance.getDroneFlightTime(custId, 0);
+    trip.energy = (drone.beta * (trip.load / 2) + drone.gamma) * trip.completionTime;
+    trip.last = custId;
+    
+    // Nối thêm c không làm trip ngắn đi, tải tăng ít nhất minDroneDemand
+    double lightestLoad = trip.load + minDroneDemand;
+    trip.closed = lightestLoad > drone.maxCapacity ||
+        (drone.beta * (lightestLoad / 2) + drone.gamma) * trip.completionTime >
+            drone.maxEnergy * (1 + DRONE_PRUNE_TOLERANCE);
+}
+
+
+
+// ==================== REGRET-K ====================
+
+// Mỗi bước chọn customer chưa chèn có regret lớn nhất, regret = tổng chênh lệch
+// giữa k route rẻ nhất và route rẻ nhất của nó (customer ít route khả thi hơn
+// được ưu tiên trước), hòa → customer đứng trước trong hoán vị. Chi phí mỗi
+// route lấy từ insertionCache nên mỗi bước chỉ tính lại route vừa nhận
+// customer: O(số customer còn lại × độ dài route đó) thay vì O(tổng độ dài).
+void Decoder::decodeRegret(const std::vector<int>& permutation, Solution& solution) {
+    ScratchArena& arena = ScratchArena::local();
+    ScratchArena::Scope scope(arena);
+    
+    int n = instance.getNumCustomers();
+    int numRoutes = instance.numTrucks + instance.numDrones;
+    int k = std::min(params.regretK, numRoutes);
+    
+    resetSolution(solution);
+    insertionCache.resize((size_t)(n + 1) * numRoutes);
+    routeVersion.resize(numRoutes);
+    for (auto& version : routeVersion) {
+        version = ++nextVersion;
+    }
     
-    // ========== OLD COST ========== (Dòng ~285)
-if (!newTrip && tripId < (int)current.droneRoutes[droneId].size()) {
-    const auto& trip = current.droneRoutes[droneId][tripId];
+    // Customer chưa chèn, theo thứ tự hoán vị (bỏ phần tử lặp)
+    bool* queued = arena.allocate<bool>(n + 1);
+    std::fill(queued, queued + n + 1, false);
+    int* pending = arena.allocate<int>(permutation.size());
+    int numPending = 0;
+    for (int custId : permutation) {
+        if (!queued[custId]) {
+            queued[custId] = true;
+            pending[numPending++] = custId;
+        }
+    }
     
-    if (!trip.customers.empty()) {
-        double currentTime = 0;
-        double currentLoad = 0;
+    double* kBest = arena.allocate<double>(k);
+    while (numPending > 0) {
+        int chosen = -1;
+        int chosenFeasible = 0;
+        double chosenRegret = 0;
+        InsertionMove chosenMove;
         
-        // Depot → customers → Depot
-        for (size_t i = 0; i < trip.customers.size(); i++) {
-            int custId_old = trip.customers[i];
-            const Customer& c = instance.customers[custId_old - 1];
-            
-            currentLoad += c.demand;
+        for (int i = 0; i < numPending; i++) {
+            int custId = pending[i];
             
-            // Travel time
-            double distance = instance.getDistance(
-                (i == 0) ? 0 : trip.customers[i-1], 
-                custId_old
-            );
-            
-            // ✅ FIX: Dùng emptySpeed thay vì maxSpeed
-            double speed = instance.droneParams.cruiseSpeed;
-            currentTime += distance / speed;
+            // k chi phí nhỏ nhất (tăng dần) và move rẻ nhất, chọn giữa truck và
+            // drone giống hệt insertCustomer
+            int feasible = 0;
+            const InsertionMove* bestTruck = nullptr;
+            const InsertionMove* bestDrone = nullptr;
+            for (int r = 0; r < numRoutes; r++) {
+                const InsertionMove& move = cachedMove(custId, r, solution);
+                if (move.cost >= INF) continue;
+                const InsertionMove*& best = r < instance.numTrucks ? bestTruck : bestDrone;
+                if (!best || move.cost < best->cost) best = &move;
+                
+                int j = std::min(feasible, k - 1);
+                if (feasible == k && move.cost >= kBest[j]) continue;
+                while (j > 0 && kBest[j - 1] > move.cost) {
+                    kBest[j] = kBest[j - 1];
+                    j--;
+                }
+                kBest[j] = move.cost;
+                feasible = std::min(feasible + 1, k);
+            }
             
-            // Service
-            currentTime += c.serviceTimeDrone;
+            double regret = 0;
+            for (int j = 1; j < feasible; j++) {
+                regret += kBest[j] - kBest[0];
+            }
             
-            // Waiting
-            oldWaitingTime += currentTime;
+            if (chosen < 0 || feasible < chosenFeasible ||
+                (feasible == chosenFeasible && regret > chosenRegret)) {
+                chosen = i;
+                chosenFeasible = feasible;
+                chosenRegret = regret;
+                chosenMove = (bestTruck && (!bestDrone || bestTruck->cost < bestDrone->cost))
+                                 ? *bestTruck : bestDrone ? *bestDrone : InsertionMove();
+            }
         }
         
-        // Return
-        double returnDist = instance.getDistance(trip.customers.back(), 0);
-        double speed = instance.droneParams.cruiseSpeed;
-        currentTime += returnDist / speed;
+        int custId = pending[chosen];
+        std::copy(pending + chosen + 1, pending + numPending, pending + chosen);
+        numPending--;
         
-        oldCompletionTime = currentTime;
+        // Không route nào nhận được (vd. staff-only khi không có truck) → bỏ qua
+        if (chosenFeasible == 0) continue;
+        
+        applyInsertion(custId, chosenMove, solution);
+        int routeIdx = chosenMove.routeType == 0 ? chosenMove.routeId
+                                                 : instance.numTrucks + chosenMove.routeId;
+        routeVersion[routeIdx] = ++nextVersion;
     }
+    
+    evaluator.evaluate(solution);
 }
 
-    
-    // ========== NEW COST ==========
-    double newCompletionTime = 0;
-    double newWaitingTime = 0;
-    
-    std::vector<int> newTripCustomers;
-    
-    if (newTrip) {
-        // New trip: chỉ có custId
-        newTripCustomers = {custId};
-    } else {
-        // Existing trip: thêm custId vào cuối
-        newTripCustomers = current.droneRoutes[droneId][tripId].customers;
-        newTripCustomers.push_back(custId);
+const Decoder::InsertionMove& Decoder::cachedMove(int custId, int routeIdx,
+                                                  Solution& solution) {
+    int numRoutes = instance.numTrucks + instance.numDrones;
+    CachedMove& entry = insertionCache[(size_t)custId * numRoutes + routeIdx];
+    if (entry.version != routeVersion[routeIdx]) {
+        if (routeIdx < instance.numTrucks) {
+            entry.move = findBestTruckPosition(custId, routeIdx, solution);
+        } else if (!instance.customers[custId - 1].isStaffOnly) {
+            entry.move = findBestDroneTrip(custId, routeIdx - instance.numTrucks);
+        } else {
+            entry.move = InsertionMove();
+        }
+        entry.version = routeVersion[routeIdx];
     }
-    
-    // ========== NEW COST ========== (Dòng ~325)
-double currentTime = 0;
-
-for (size_t i = 0; i < newTripCustomers.size(); i++) {
-    int cid = newTripCustomers[i];
-    const Customer& c = instance.customers[cid - 1];
-    
-    // Travel
-    double distance = instance.getDistance(
-        (i == 0) ? 0 : newTripCustomers[i-1],
-        cid
-    );
-    
-    // ✅ FIX: Dùng emptySpeed
-    double speed = instance.droneParams.cruiseSpeed;
-    currentTime += distance / speed;
-    
-    // Service
-    currentTime += c.serviceTimeDrone;
-    
-    // Waiting
-    newWaitingTime += currentTime;
+    return entry.move;
 }
 
-// Return
-double returnDist = instance.getDistance(newTripCustomers.back(), 0);
-double speed = instance.droneParams.cruiseSpeed;
-currentTime += returnDist / speed;
 
-newCompletionTime = currentTime;
 
+// ==================== SPLIT DECODER ====================
+
+// Split kiểu Prins: coi hoán vị là giant tour, cắt thành các đoạn liên tiếp,
+// mỗi đoạn là một truck route (tối đa numTrucks đoạn) hoặc một drone trip
+// (không giới hạn số trip, mọi trip xuất phát lúc 0 như trong evaluator).
+//   V[j][k] = chi phí nhỏ nhất phục vụ j customer đầu với k truck route
+//   truck (i, j]: V[j][k] ← V[i][k-1] + cost,   drone (i, j]: V[j][k] ← V[i][k] + cost
+// cost của một route = 0.5·CT + 0.5·WT, truck chạy tốc độ hằng maxSpeed như
+// khi chèn (mục tiêu cuối cùng vẫn do evaluator tính). Chi phí route được tính
+// tăng dần khi kéo dài đoạn nên mỗi cặp (i, j) là O(1); truck route dài tối đa
+// L, drone trip bị chặn bởi tải / năng lượng → O(n·L·K).
+bool Decoder::decodeSplit(const std::vector<int>& permutation, Solution& solution) {
+    ScratchArena& arena = ScratchArena::local();
+    ScratchArena::Scope scope(arena);
+    
+    int numCustomers = instance.getNumCustomers();
+    int numTrucks = instance.numTrucks;
+    int numDrones = instance.numDrones;
+    const DroneParams& drone = instance.droneParams;
+    
+    // Giant tour (bỏ customer lặp lại như decodeInsertion)
+    bool* served = arena.allocate<bool>(numCustomers + 1);
+    std::fill(served, served + numCustomers + 1, false);
+    int* tour = arena.allocate<int>(permutation.size());
+    int n = 0;
+    for (int custId : permutation) {
+        if (served[custId]) continue;
+        served[custId] = true;
+        tour[n++] = custId;
+    }
     
-    // ========== Check Energy Constraint ==========
-    // Simple energy check (có thể refine)
-    double totalEnergy = 0;
-    double currentLoad = 0;
-    
-    for (int cid : newTripCustomers) {
-        currentLoad += instance.customers[cid - 1].demand;
+    int maxTruckLength = params.splitMaxRouteLength;
+    if (maxTruckLength <= 0) {
+        maxTruckLength = (numTrucks > 0) ? 2 * ((n + numTrucks - 1) / numTrucks) : 0;
     }
     
-    // Power = beta * load + gamma
-    double avgPower = instance.droneParams.beta * (currentLoad / 2) + 
-                     instance.droneParams.gamma;
-    totalEnergy = avgPower * newCompletionTime;
+    // V, predecessor: hàng j có numTrucks + 1 cột
+    int width = numTrucks + 1;
+    double* cost = arena.allocate<double>((n + 1) * width);
+    int* predStart = arena.allocate<int>((n + 1) * width);
+    bool* predIsTruck = arena.allocate<bool>((n + 1) * width);
+    std::fill(cost, cost + (n + 1) * width, INF);
+    cost[0] = 0;
+    
+    for (int i = 0; i < n; i++) {
+        const double* from = cost + i * width;
+        bool reachable = false;
+        for (int k = 0; k < width; k++) reachable |= from[k] < INF;
+        if (!reachable) continue;
+        
+        // Truck route tour[i..j): cộng dồn thời điểm lấy mẫu
+        double time = 0, sumCollect = 0;
+        int prev = 0;
+        for (int j = i + 1; j <= n && j - i <= maxTruckLength && numTrucks > 0; j++) {
+            int custId = tour[j - 1];
+            time += instance.getTruckTime(prev, custId);
+            sumCollect += time;
+            time += instance.customers[custId - 1].serviceTimeTruck;
+            prev = custId;
+            
+            double completion = time + instance.getTruckTime(custId, 0);
+            double waiting = (j - i) * completion - sumCollect;
+            double routeCost = 0.5 * completion + 0.5 * waiting;
+            
+            double* to = cost + j * width;
+            for (int k = 1; k < width; k++) {
+                if (from[k - 1] + routeCost < to[k]) {
+                    to[k] = from[k - 1] + routeCost;
+                    predStart[j * width + k] = i;
+                    predIsTruck[j * width + k] = true;
+                }
+            }
+        }
+        
+        // Drone trip tour[i..j). Năng lượng = Σ (β·tải + γ)·t qua các chặng, tải
+        // giảm dần sau mỗi customer: E = (βW + γ)·T − β·Σ P·t, P = tải đã giao
+        // trước chặng đó (chặng về depot có P = W)
+        time = 0;
+        sumCollect = 0;
+        prev = 0;
+        double load = 0, flightToCustomers = 0, deliveredTimesFlight = 0;
+        for (int j = i + 1; j <= n && numDrones > 0; j++) {
+            int custId = tour[j - 1];
+            const Customer& cust = instance.customers[custId - 1];
+            if (cust.isStaffOnly) break;
+            load += cust.demand;
+            if (load > drone.maxCapacity) break;
+            
+            double leg = instance.getDroneFlightTime(prev, custId);
+            deliveredTimesFlight += (load - cust.demand) * leg;
+            flightToCustomers += leg;
+            time += leg;
+            sumCollect += time;
+            time += cust.serviceTimeDrone;
+            prev = custId;
+            
+            double back = instance.getDroneFlightTime(custId, 0);
+            double energy = ((drone.beta * load + drone.gamma) * (flightToCustomers + back) -
+                             drone.beta * (deliveredTimesFlight + load * back)) / 1000.0;
+            if (energy > drone.maxEnergy) break;  // kéo dài thêm chỉ tốn thêm năng lượng
+            
+            double completion = time + back;
+            double waiting = (j - i) * completion - sumCollect;
+            double routeCost = 0.5 * completion + 0.5 * waiting;
+            
+            double* to = cost + j * width;
+            for (int k = 0; k < width; k++) {
+                if (from[k] + routeCost < to[k]) {
+                    to[k] = from[k] + routeCost;
+                    predStart[j * width + k] = i;
+                    predIsTruck[j * width + k] = false;
+                }
+            }
+        }
+    }
     
-    if (totalEnergy > instance.droneParams.maxEnergy) {
-        return INF;  // Infeasible
+    int bestK = 0;
+    for (int k = 1; k < width; k++) {
+        if (cost[n * width + k] < cost[n * width + bestK]) bestK = k;
+    }
+    if (!(cost[n * width + bestK] < INF)) return false;
+    
+    // Truy vết: đoạn được lấy từ cuối tour về đầu
+    int* segStart = arena.allocate<int>(n + 1);
+    bool* segIsTruck = arena.allocate<bool>(n + 1);
+    int numSegments = 0;
+    for (int j = n, k = bestK; j > 0; ) {
+        int i = predStart[j * width + k];
+        bool isTruck = predIsTruck[j * width + k];
+        segStart[numSegments] = i;
+        segIsTruck[numSegments] = isTruck;
+        numSegments++;
+        if (isTruck) k--;
+        j = i;
     }
     
-    // ========== DELTA COST ==========
-    double deltaCT = newCompletionTime - oldCompletionTime;
-    double deltaWT = newWaitingTime - oldWaitingTime;
+    // Dựng lời giải: truck route theo thứ tự trong tour, drone trip chia vòng
+    // tròn cho các drone (trip độc lập về thời gian nên cách chia không đổi mục tiêu)
+    solution.truckRoutes.resize(numTrucks);
+    for (auto& route : solution.truckRoutes) {
+        route.clear();
+    }
+    solution.droneRoutes.resize(numDrones);
+    for (auto& trips : solution.droneRoutes) {
+        RouteBufferPool::local().resizeTrips(trips, 0);
+    }
     
-    double deltaCost = 0.5 * deltaCT + 0.5 * deltaWT;
+    int truckId = 0, tripCount = 0;
+    for (int s = numSegments - 1; s >= 0; s--) {
+        int begin = segStart[s];
+        int end = (s > 0) ? segStart[s - 1] : n;
+        Route* route;
+        if (segIsTruck[s]) {
+            route = &solution.truckRoutes[truckId++];
+        } else {
+            route = &RouteBufferPool::local().addTrip(solution.droneRoutes[tripCount % numDrones]);
+            tripCount++;
+        }
+        route->customers.assign(tour + begin, tour + end);
+    }
     
-    return deltaCost;
+    solution.paretoRank = 0;
+    solution.crowdingDistance = 0;
+    evaluator.evaluate(solution);
+    solution.solutionHash = hasher.computeHash(solution);
+    return true;
 }
-
-
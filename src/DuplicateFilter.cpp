@@ -0,0 +1,79 @@
+#include "DuplicateFilter.h"
+#include <algorithm>
+
+DuplicateFilter::DuplicateFilter(size_t memoryBytes) {
+    configure(memoryBytes);
+}
+
+void DuplicateFilter::configure(size_t memoryBytes) {
+    // Lũy thừa của 2 lớn nhất vừa ngân sách, tối thiểu một cache line mỗi bảng
+    size_t slots = std::max<size_t>(memoryBytes / (2 * sizeof(uint64_t)), 8);
+    tableSize = 8;
+    while (tableSize * 2 <= slots) tableSize *= 2;
+    mask = tableSize - 1;
+    maxPerGeneration = static_cast<size_t>(tableSize * MAX_LOAD);
+
+    current.assign(tableSize, EMPTY);
+    previous.assign(tableSize, EMPTY);
+    currentCount = 0;
+    previousCount = 0;
+    generation = 0;
+}
+
+void DuplicateFilter::clear() {
+    std::fill(current.begin(), current.end(), EMPTY);
+    std::fill(previous.begin(), previous.end(), EMPTY);
+    currentCount = 0;
+    previousCount = 0;
+    generation = 0;
+}
+
+size_t DuplicateFilter::home(uint64_t k) const {
+    // Trộn lại bit (Fibonacci hashing) để hash có bit thấp yếu vẫn rải đều
+    return ((k * 0x9E3779B97F4A7C15ULL) >> 32) & mask;
+}
+
+bool DuplicateFilter::find(const std::vector<uint64_t>& table, size_t start,
+                           size_t mask, uint64_t k) {
+    // Tải ≤ 50% nên chuỗi dò ngắn và luôn gặp ô trống
+    for (size_t i = start; ; i = (i + 1) & mask) {
+        if (table[i] == k) return true;
+        if (table[i] == EMPTY) return false;
+    }
+}
+
+bool DuplicateFilter::contains(uint64_t hash) const {
+    uint64_t k = key(hash);
+    size_t start = home(k);
+    return find(current, start, mask, k) || find(previous, start, mask, k);
+}
+
+bool DuplicateFilter::insert(uint64_t hash) {
+    uint64_t k = key(hash);
+    size_t start = home(k);
+    if (find(current, start, mask, k)) return false;
+
+    bool seenBefore = find(previous, start, mask, k);
+    // Gặp lại ở thế hệ cũ → chuyển lên thế hệ hiện tại
+    insertNew(k);
+    return !seenBefore;
+}
+
+void DuplicateFilter::insertNew(uint64_t k) {
+    if (currentCount >= maxPerGeneration) {
+        advanceGeneration();
+    }
+    size_t i = home(k);
+    while (current[i] != EMPTY) i = (i + 1) & mask;
+    current[i] = k;
+    currentCount++;
+}
+
+void DuplicateFilter::advanceGeneration() {
+    // Bỏ thế hệ cũ nhất; bảng của nó được xóa và dùng lại làm thế hệ mới
+    std::swap(current, previous);
+    std::fill(current.begin(), current.end(), EMPTY);
+    previousCount = currentCount;
+    currentCount = 0;
+    generation++;
+}
@@ -1,42 +1,74 @@
 #include "ICAHGS.h"
+#include "AllocCounter.h"
+#include "ScratchArena.h"
 #include <algorithm>
+#include <cassert>
 #include <ctime>
 #include <iostream>
 #include <limits> // Thêm thư viện này để sử dụng giá trị lớn nhất/nhỏ nhất
-#include <unordered_set>  // ← THÊM
 #include <cstdint> 
 
-ICAHGS::ICAHGS(const Instance& inst, int popSize, int numEmp) 
-    : instance(inst), decoder(inst), localSearch(inst),
+ICAHGS::ICAHGS(const Instance& inst, int popSize, int numEmp, const ICAHGSOptions& opts) 
+    : instance(inst), options(opts), decoder(inst, opts.decoder),
+      localSearch(inst, opts.localSearch),
       populationSize(popSize), numImperialists(numEmp) {
     
-    rng.seed(static_cast<unsigned int>(time(nullptr)));
-    // **THÊM MỚI: Khởi tạo hasher**
-    hasher = new SolutionHasher(
-        instance.getNumCustomers(),
-        instance.numTrucks,
-        instance.numDrones
-    );
-}
-ICAHGS::~ICAHGS() {
-    delete hasher;
+    rng.seed(options.seed != 0 ? options.seed : static_cast<unsigned int>(time(nullptr)));
+    seenHashes.configure(options.duplicateFilterBytes);
+    decodeCache.configure(options.decodeCacheSize, instance.getNumCustomers(),
+                          instance.numTrucks + instance.getNumCustomers());
+    
+    // Island mode mặc định một thread cho mỗi island
+    int numThreads = options.numThreads;
+    if (options.numIslands > 1 && numThreads <= 1) {
+        numThreads = options.numIslands;
+    }
+    if (numThreads > 1) {
+        for (int i = 0; i < numThreads; i++) {
+            workers.emplace_back(new Worker(instance, options));
+        }
+        pool.reset(new ThreadPool(numThreads));
+    }
 }
 
-std::vector<Solution> ICAHGS::run(int maxIterations) {
+std::vector<FlatSolution> ICAHGS::run(int maxIterations) {
     std::cout << "Initializing population..." << std::endl;
     initializePopulation();
     
     std::cout << "Starting ICAHGS optimization..." << std::endl;
     
+    if (options.numIslands > 1) {
+        runIslands(maxIterations);
+        printDecodeCacheStats();
+        std::cout << "Optimization complete. Final archive size: " 
+                  << paretoArchive.size() << std::endl;
+        return paretoArchive.toVector();
+    }
+    
     for (int iter = 0; iter < maxIterations; iter++) {
         std::cout << "Iteration " << (iter + 1) << "/" << maxIterations << std::endl;
+        uint64_t allocationsBefore = AllocCounter::count();
         
         // Assimilation and Revolution
-        assimilationAndRevolution();
+        if (pool) {
+            assimilationAndRevolutionParallel();
+        } else {
+            assimilationAndRevolution();
+        }
         
         // Imperialistic Competition
         imperialisticCompetition();
         
+        if (AllocCounter::enabled()) {
+            std::cout << "  Heap allocations: "
+                      << (AllocCounter::count() - allocationsBefore) << std::endl;
+        }
+        
+        // Multi-process: trao đổi migrant định kỳ
+        if (options.channel && (iter + 1) % options.migrationInterval == 0) {
+            exchangeMigrants();
+        }
+        
         // Print progress
         if ((iter + 1) % 10 == 0) {
             std::cout << "  Archive size: " << paretoArchive.size() << std::endl;
@@ -50,28 +82,57 @@ std::vector<Solution> ICAHGS::run(int maxIterations) {
         }
     }
     
+    printDecodeCacheStats();
     std::cout << "Optimization complete. Final archive size: " 
               << paretoArchive.size() << std::endl;
     
-    return paretoArchive;
+    return paretoArchive.toVector();
 }
 
 bool ICAHGS::isDuplicate(Solution& solution) {
-    // Tính hash cho solution
-    solution.solutionHash = hasher->computeHash(solution);
+    return isDuplicate(solution, seenHashes);
+}
+
+bool ICAHGS::isDuplicate(Solution& solution, DuplicateFilter& seenHashes) {
+    // solutionHash đã được Decoder cập nhật tăng dần khi chèn từng customer
     
-    // Kiểm tra hash đã tồn tại chưa
-    if (seenHashes.find(solution.solutionHash) != seenHashes.end()) {
-        return true;  // TRÙNG LẶP!
+    // Kiểm tra và thêm trong một lần dò; false → chưa có (KHÔNG TRÙNG)
+    return !seenHashes.insert(solution.solutionHash);
+}
+
+const DecodeCache::Entry* ICAHGS::decodeCached(const std::vector<int>& permutation,
+                                               Decoder& dec, DecodeCache& cache,
+                                               Solution& solution, uint64_t& decodedHash) {
+    const DecodeCache::Entry* cached = cache.find(permutation);
+    if (cached) {
+        decodedHash = cached->decodedHash;
+    } else {
+        dec.decode(permutation, solution);
+        decodedHash = solution.solutionHash;
     }
-    
-    // Chưa tồn tại, thêm vào
-    seenHashes.insert(solution.solutionHash);
-    return false;  // KHÔNG TRÙNG
+    return cached;
+}
+
+void ICAHGS::printDecodeCacheStats() const {
+    if (!decodeCache.enabled()) return;
+    
+    uint64_t hits = decodeCache.hits();
+    uint64_t misses = decodeCache.misses();
+    for (const auto& worker : workers) {
+        hits += worker->decodeCache.hits();
+        misses += worker->decodeCache.misses();
+    }
+    uint64_t lookups = hits + misses;
+    std::cout << "Decode cache: " << hits << " hits, " << misses << " misses";
+    if (lookups > 0) {
+        std::cout << " (hit rate " << (100.0 * hits / lookups) << "%)";
+    }
+    std::cout << std::endl;
 }
 
 void ICAHGS::initializePopulation() {
-    std::vector<Individual> population;
+    population.clear();
+    population.reserve(populationSize);
     int attempts = 0;
     int maxAttemptsPerSolution = 100;  // Tối đa 100 attempts cho mỗi solution
     
@@ -130,12 +191,12 @@ void ICAHGS::initializePopulation() {
     }
     
     // Create empires
-    createEmpires(population);
+    createEmpires();
 }
 
 
 
-void ICAHGS::createEmpires(std::vector<Individual>& population) {
+void ICAHGS::createEmpires() {
     if (population.empty()) {
         std::cerr << "ERROR: Population is empty!" << std::endl;
         return;
@@ -150,10 +211,9 @@ void ICAHGS::createEmpires(std::vector<Individual>& population) {
     ParetoRanking::calculateCrowdingDistance(solutions);
     
     // ========== BƯỚC 2: Group by Front ==========
-    std::map<int, std::vector<Individual>> fronts;
-    for (auto& ind : population) {
-        int rank = ind.solution.paretoRank;
-        fronts[rank].push_back(ind);
+    std::map<int, std::vector<int>> fronts;
+    for (size_t i = 0; i < population.size(); i++) {
+        fronts[population[i].solution.paretoRank].push_back(i);
     }
     
     std::cout << "Fronts structure:" << std::endl;
@@ -162,7 +222,8 @@ void ICAHGS::createEmpires(std::vector<Individual>& population) {
     }
     
     // ========== BƯỚC 3: Chọn Imperialists từ Fronts ==========
-    std::vector<Individual> imperialists;
+    std::vector<int> imperialists;
+    std::vector<char> isImperialist(population.size(), 0);
     
     for (auto& [rank, front] : fronts) {
         // Shuffle để random chọn
@@ -170,8 +231,10 @@ void ICAHGS::createEmpires(std::vector<Individual>& population) {
         
         std::cout << "Selecting from Front " << rank << "..." << std::endl;
         
-        for (auto& ind : front) {
-            imperialists.push_back(ind);
+        for (int idx : front) {
+            const Individual& ind = population[idx];
+            imperialists.push_back(idx);
+            isImperialist[idx] = 1;
             std::cout << "  Selected imperialist #" << imperialists.size() 
                       << " (rank=" << ind.solution.paretoRank 
                       << ", CT=" << ind.solution.systemCompletionTime 
@@ -194,7 +257,7 @@ void ICAHGS::createEmpires(std::vector<Individual>& population) {
     
     // ========== BƯỚC 4: Tạo Empires ==========
     empires.clear();
-    for (auto& imp : imperialists) {
+    for (int imp : imperialists) {
         Empire empire;
         empire.imperialist = imp;
         empire.power = 0;
@@ -204,10 +267,12 @@ void ICAHGS::createEmpires(std::vector<Individual>& population) {
     std::cout << "Created " << empires.size() << " empires" << std::endl;
     
     // ========== BƯỚC 5: Phân Colonies ==========
+    // Mỗi cá thể không phải imperialist là colony của đúng một empire
     int colonyIndex = 0;
-    for (size_t i = numImperialists; i < population.size(); i++) {
+    for (size_t i = 0; i < population.size(); i++) {
+        if (isImperialist[i]) continue;
         int empireIdx = colonyIndex % empires.size();
-        empires[empireIdx].colonies.push_back(population[i]);
+        empires[empireIdx].colonies.push_back(i);
         colonyIndex++;
     }
     
@@ -216,7 +281,7 @@ void ICAHGS::createEmpires(std::vector<Individual>& population) {
         empire.power = calculateEmpirePower(empire);
     }
     
-    std::cout << "Distributed " << (population.size() - numImperialists) 
+    std::cout << "Distributed " << colonyIndex 
               << " colonies among " << empires.size() << " empires" << std::endl;
 }
 
@@ -224,55 +289,353 @@ void ICAHGS::createEmpires(std::vector<Individual>& population) {
 
 void ICAHGS::assimilationAndRevolution() {
     for (auto& empire : empires) {
-        for (size_t c = 0; c < empire.colonies.size(); c++) {
-            // Crossover (Assimilation)
-            std::vector<int> offspring = orderCrossover(
-                empire.imperialist.permutation,
-                empire.colonies[c].permutation);
+        assimilateEmpire(empire, decoder, localSearch, rng, seenHashes, paretoArchive,
+                         mainScratch, decodeCache);
+    }
+}
+
+// Assimilation + revolution cho một empire với bộ công cụ / bộ nhớ được truyền
+// vào, để dùng chung giữa chế độ tuần tự và các island.
+void ICAHGS::assimilateEmpire(Empire& empire, Decoder& dec, LocalSearch& ls,
+                              std::mt19937& gen, DuplicateFilter& seen,
+                              ParetoArchive& archive, OffspringScratch& scratch,
+                              DecodeCache& cache) {
+    std::vector<int>& offspring = scratch.permutation;
+    Solution& offspringSol = scratch.solution;
+    uint64_t decodedHash;
+    
+    // Offspring thường chung prefix với imperialist → chỉ decode lại phần đuôi
+    if (!empire.colonies.empty()) {
+        dec.setReference(population[empire.imperialist].permutation);
+    }
+    
+    for (size_t c = 0; c < empire.colonies.size(); c++) {
+        ScratchArena::local().reset();
+        Individual& colony = population[empire.colonies[c]];
+        
+        // Crossover (Assimilation)
+        orderCrossover(population[empire.imperialist].permutation,
+                       colony.permutation, offspring, gen);
+        
+        // Mutation (Revolution)
+        mutate(offspring, 0.05, gen);
+        
+        // Decode (bỏ qua nếu hoán vị đã có trong cache)
+        const DecodeCache::Entry* cached = decodeCached(offspring, dec, cache,
+                                                        offspringSol, decodedHash);
+        
+        // **KIỂM TRA DUPLICATE**
+        if (!seen.insert(decodedHash)) {
+            if (!cached) cache.insert(offspring, decodedHash, nullptr);
             
-            // Mutation (Revolution)
-            mutate(offspring, 0.05);
+            // Nếu trùng, thử mutation mạnh hơn
+            mutate(offspring, 0.15, gen);  // Mutation rate cao hơn
+            cached = decodeCached(offspring, dec, cache, offspringSol, decodedHash);
             
-            // Decode
-            Solution offspringSol = decoder.decode(offspring);
+            // Check lại
+            if (!seen.insert(decodedHash)) {
+                if (!cached) cache.insert(offspring, decodedHash, nullptr);
+                continue;  // Skip nếu vẫn trùng
+            }
+        }
+        
+        // Local search (hoặc lấy kết quả đã có)
+        if (cached && cached->improved) {
+            cached->result.expandInto(offspringSol);
+        } else {
+            if (cached) dec.decode(offspring, offspringSol);  // cache chỉ có hash
+            ls.improveInPlace(offspringSol, 50);
+            cache.insert(offspring, decodedHash, &offspringSol);
+        }
+        
+        // Update archive
+        archive.insert(offspringSol);
+        
+        // Replace colony if better (đổi buffer với slot trong pool, không copy)
+        if (offspringSol.dominates(colony.solution) ||
+            (offspringSol.systemCompletionTime < INF && 
+             colony.solution.systemCompletionTime >= INF)) {
+            colony.permutation.swap(offspring);
+            std::swap(colony.solution, offspringSol);
             
-            // **KIỂM TRA DUPLICATE**
-            if (isDuplicate(offspringSol)) {
-                // Nếu trùng, thử mutation mạnh hơn
-                mutate(offspring, 0.15);  // Mutation rate cao hơn
-                offspringSol = decoder.decode(offspring);
-                
-                // Check lại
-                if (isDuplicate(offspringSol)) {
-                    continue;  // Skip nếu vẫn trùng
+            // Revolution
+            if (colony.solution.dominates(population[empire.imperialist].solution)) {
+                std::swap(empire.imperialist, empire.colonies[c]);
+            }
+        }
+    }
+    
+    // Update empire power
+    empire.power = calculateEmpirePower(empire);
+}
+
+// ==================== ISLAND MODEL ====================
+
+// Mỗi island giữ một nhóm empire và tiến hóa độc lập trên thread riêng trong
+// migrationInterval iteration. Chỉ đồng bộ ở cuối mỗi epoch: gộp archive cục bộ
+// vào paretoArchive, trao đổi colony theo vòng, rồi imperialisticCompetition.
+void ICAHGS::runIslands(int maxIterations) {
+    int numIslands = options.numIslands;
+    islands.clear();
+    islands.resize(numIslands);
+    for (auto& island : islands) {
+        island.rng.seed(rng());
+        island.seenHashes = seenHashes;
+    }
+    
+    int iter = 0;
+    while (iter < maxIterations) {
+        int epochLength = std::min(options.migrationInterval, maxIterations - iter);
+        assert(epochLength > 0);  // migrationInterval >= 1, main.cpp kiểm tra
+        uint64_t allocationsBefore = AllocCounter::count();
+        
+        // Chia empire cho island (round-robin, empire có thể đã sụp đổ)
+        for (auto& island : islands) island.empireIds.clear();
+        for (size_t e = 0; e < empires.size(); e++) {
+            islands[e % numIslands].empireIds.push_back(e);
+        }
+        
+        pool->run(numIslands, [this, epochLength](int islandIdx, int workerId) {
+            Worker& worker = *workers[workerId];
+            Island& island = islands[islandIdx];
+            for (int i = 0; i < epochLength; i++) {
+                for (int e : island.empireIds) {
+                    assimilateEmpire(empires[e], worker.decoder, worker.localSearch,
+                                     island.rng, island.seenHashes, island.archive,
+                                     worker.scratch, worker.decodeCache);
                 }
             }
+        });
+        iter += epochLength;
+        
+        // ===== Epoch: đồng bộ trên snapshot nhất quán =====
+        for (const auto& island : islands) {
+            for (size_t i = 0; i < island.archive.size(); i++) {
+                paretoArchive.insert(island.archive[i]);
+            }
+        }
+        
+        migrateColonies();
+        if (options.channel) {
+            exchangeMigrants();
+        }
+        imperialisticCompetition();
+        
+        std::cout << "Epoch done at iteration " << iter << "/" << maxIterations
+                  << "  Archive size: " << paretoArchive.size()
+                  << "  Number of empires: " << empires.size() << std::endl;
+        if (AllocCounter::enabled()) {
+            std::cout << "  Heap allocations: "
+                      << (AllocCounter::count() - allocationsBefore) << std::endl;
+        }
+        
+        // Check convergence
+        if (empires.size() <= 1) {
+            std::cout << "Converged: only one or zero empire remains" << std::endl;
+            break;
+        }
+    }
+}
+
+// Di cư theo vòng: island i gửi migrationSize colony ngẫu nhiên sang island i+1.
+// Lấy hết migrants ra trước rồi mới phân phát, nên island nhận không gửi lại
+// chính colony vừa nhận.
+void ICAHGS::migrateColonies() {
+    int numIslands = islands.size();
+    std::vector<std::vector<int>> migrants(numIslands);
+    
+    for (int i = 0; i < numIslands; i++) {
+        const auto& ids = islands[i].empireIds;
+        if (ids.empty()) continue;
+        
+        for (int m = 0; m < options.migrationSize; m++) {
+            std::uniform_int_distribution<int> pickEmpire(0, ids.size() - 1);
+            Empire& source = empires[ids[pickEmpire(rng)]];
+            if (source.colonies.size() <= 1) continue;  // giữ lại ít nhất một colony
             
-            // Local search
-            offspringSol = localSearch.improve(offspringSol, 50);
-            
-            // Update archive
-            updateParetoArchive(offspringSol);
-            
-            // Replace colony if better
-            if (offspringSol.dominates(empire.colonies[c].solution) ||
-                (offspringSol.systemCompletionTime < INF && 
-                 empire.colonies[c].solution.systemCompletionTime >= INF)) {
-                empire.colonies[c].permutation = offspring;
-                empire.colonies[c].solution = offspringSol;
-                
-                // Revolution
-                if (offspringSol.dominates(empire.imperialist.solution)) {
-                    std::swap(empire.imperialist, empire.colonies[c]);
-                }
+            int colonyIdx = selectRandomColony(source);
+            migrants[i].push_back(source.colonies[colonyIdx]);
+            source.colonies.erase(source.colonies.begin() + colonyIdx);
+        }
+    }
+    
+    for (int i = 0; i < numIslands; i++) {
+        const auto& ids = islands[(i + 1) % numIslands].empireIds;
+        if (ids.empty()) {
+            // Không có nơi nhận → trả về island gốc
+            const auto& own = islands[i].empireIds;
+            for (int ind : migrants[i]) empires[own[0]].colonies.push_back(ind);
+            continue;
+        }
+        
+        std::uniform_int_distribution<int> pickEmpire(0, ids.size() - 1);
+        for (int ind : migrants[i]) {
+            empires[ids[pickEmpire(rng)]].colonies.push_back(ind);
+        }
+    }
+    
+    for (auto& empire : empires) {
+        empire.power = calculateEmpirePower(empire);
+    }
+}
+
+// ==================== MULTI-PROCESS MIGRATION ====================
+
+// Gửi imperialist ngẫu nhiên cho process kế tiếp, nhận migrant đang chờ từ
+// process trước và đẩy archive hiện tại cho coordinator. Không bao giờ chờ:
+// process chậm chỉ làm mất vài migrant chứ không làm các process khác dừng.
+void ICAHGS::exchangeMigrants() {
+    MigrationChannel& channel = *options.channel;
+    if (empires.empty()) return;
+    std::uniform_int_distribution<int> pickEmpire(0, empires.size() - 1);
+    
+    for (int m = 0; m < options.migrationSize; m++) {
+        channel.sendMigrant(population[empires[pickEmpire(rng)].imperialist].permutation);
+    }
+    
+    std::vector<std::vector<int>> received;
+    channel.receiveMigrants(received, 4 * options.migrationSize);
+    
+    int n = instance.getNumCustomers();
+    std::vector<char> present(n + 1);
+    for (auto& permutation : received) {
+        // Chỉ nhận hoán vị hợp lệ của 1..n
+        if ((int)permutation.size() != n) continue;
+        std::fill(present.begin(), present.end(), 0);
+        bool valid = true;
+        for (int cust : permutation) {
+            if (cust < 1 || cust > n || present[cust]) {
+                valid = false;
+                break;
             }
+            present[cust] = 1;
+        }
+        if (!valid) continue;
+        
+        Solution migrantSol = decoder.decode(permutation);
+        if (isDuplicate(migrantSol)) continue;
+        updateParetoArchive(migrantSol);
+        
+        // Ghi đè một colony ngẫu nhiên nếu colony đó không tốt hơn migrant
+        // (empire không còn colony thì bỏ qua để pool giữ nguyên kích thước)
+        Empire& target = empires[pickEmpire(rng)];
+        if (target.colonies.empty()) continue;
+        
+        Individual& colony = population[target.colonies[selectRandomColony(target)]];
+        if (!colony.solution.dominates(migrantSol)) {
+            colony.permutation = std::move(permutation);
+            colony.solution = std::move(migrantSol);
+        }
+        target.power = calculateEmpirePower(target);
+    }
+    
+    for (size_t i = 0; i < paretoArchive.size(); i++) {
+        channel.sendSolution(paretoArchive[i], false);
+    }
+}
+
+// Giống assimilationAndRevolution nhưng mọi colony của mọi empire được xử lý
+// song song từ cùng một snapshot (imperialist, seenHashes đầu lô). Worker chỉ
+// đọc trạng thái chung; kiểm tra trùng lặp trong lô, cập nhật archive và thay
+// colony được làm tuần tự theo thứ tự task sau khi cả lô xong.
+void ICAHGS::assimilationAndRevolutionParallel() {
+    // Giữ nguyên các phần tử cũ để dùng lại buffer permutation / solution
+    size_t numTasks = 0;
+    for (size_t e = 0; e < empires.size(); e++) {
+        for (size_t c = 0; c < empires[e].colonies.size(); c++) {
+            if (numTasks == offspringResults.size()) offspringResults.emplace_back();
+            OffspringResult& result = offspringResults[numTasks++];
+            result.empireIdx = e;
+            result.colonyIdx = c;
+            result.seed = rng();
         }
+    }
+    
+    pool->run(numTasks, [this](int task, int workerId) {
+        evaluateOffspring(*workers[workerId], offspringResults[task]);
+    });
+    
+    // Merge
+    for (size_t task = 0; task < numTasks; task++) {
+        OffspringResult& result = offspringResults[task];
+        if (result.skipped) continue;
+        
+        // Trùng với offspring khác trong cùng lô
+        if (!seenHashes.insert(result.decodedHash)) continue;
+        
+        Empire& empire = empires[result.empireIdx];
+        Individual& colony = population[empire.colonies[result.colonyIdx]];
+        const Solution& offspringSol = result.solution;
         
-        // Update empire power
+        // Update archive
+        updateParetoArchive(offspringSol);
+        
+        // Replace colony if better
+        if (offspringSol.dominates(colony.solution) ||
+            (offspringSol.systemCompletionTime < INF && 
+             colony.solution.systemCompletionTime >= INF)) {
+            colony.permutation.swap(result.permutation);
+            std::swap(colony.solution, result.solution);
+            
+            // Revolution
+            if (colony.solution.dominates(population[empire.imperialist].solution)) {
+                std::swap(empire.imperialist, empire.colonies[result.colonyIdx]);
+            }
+        }
+    }
+    
+    // Update empire power
+    for (auto& empire : empires) {
         empire.power = calculateEmpirePower(empire);
     }
 }
 
+// Chạy trên worker thread: chỉ đọc empires / seenHashes
+void ICAHGS::evaluateOffspring(Worker& worker, OffspringResult& result) {
+    const Empire& empire = empires[result.empireIdx];
+    ScratchArena::local().reset();
+    worker.decoder.setReference(population[empire.imperialist].permutation);
+    std::mt19937 taskRng(result.seed);
+    
+    // Crossover (Assimilation)
+    orderCrossover(population[empire.imperialist].permutation,
+                   population[empire.colonies[result.colonyIdx]].permutation,
+                   result.permutation, taskRng);
+    
+    // Mutation (Revolution)
+    mutate(result.permutation, 0.05, taskRng);
+    
+    // Decode (bỏ qua nếu hoán vị đã có trong cache)
+    DecodeCache& cache = worker.decodeCache;
+    const DecodeCache::Entry* cached = decodeCached(result.permutation, worker.decoder, cache,
+                                                    result.solution, result.decodedHash);
+    
+    // **KIỂM TRA DUPLICATE** (so với snapshot đầu lô)
+    if (seenHashes.contains(result.decodedHash)) {
+        if (!cached) cache.insert(result.permutation, result.decodedHash, nullptr);
+        
+        mutate(result.permutation, 0.15, taskRng);  // Mutation rate cao hơn
+        cached = decodeCached(result.permutation, worker.decoder, cache,
+                              result.solution, result.decodedHash);
+        
+        if (seenHashes.contains(result.decodedHash)) {
+            if (!cached) cache.insert(result.permutation, result.decodedHash, nullptr);
+            result.skipped = true;  // Skip nếu vẫn trùng
+            return;
+        }
+    }
+    
+    result.skipped = false;
+    
+    // Local search (hoặc lấy kết quả đã có)
+    if (cached && cached->improved) {
+        cached->result.expandInto(result.solution);
+    } else {
+        if (cached) worker.decoder.decode(result.permutation, result.solution);
+        worker.localSearch.improveInPlace(result.solution, 50);
+        cache.insert(result.permutation, result.decodedHash, &result.solution);
+    }
+}
 
 void ICAHGS::imperialisticCompetition() {
     if (empires.size() <= 1) return;
@@ -296,7 +659,7 @@ void ICAHGS::imperialisticCompetition() {
         }
         
         if (strongestIdx != -1) { // Đảm bảo tìm được đế chế mạnh nhất
-             empires[strongestIdx].colonies.push_back(std::move(empires[weakestIdx].imperialist));
+             empires[strongestIdx].colonies.push_back(empires[weakestIdx].imperialist);
         }
        
         empires.erase(empires.begin() + weakestIdx);
@@ -328,29 +691,35 @@ void ICAHGS::imperialisticCompetition() {
 
         if (winnerIdx != -1 && winnerIdx != weakestIdx) {
             empires[winnerIdx].colonies.push_back(
-                std::move(empires[weakestIdx].colonies[colonyIdx]));
+                empires[weakestIdx].colonies[colonyIdx]);
             empires[weakestIdx].colonies.erase(
                 empires[weakestIdx].colonies.begin() + colonyIdx);
         }
     }
 }
 
-std::vector<int> ICAHGS::orderCrossover(const std::vector<int>& parent1,
-                                         const std::vector<int>& parent2) {
+void ICAHGS::orderCrossover(const std::vector<int>& parent1,
+                            const std::vector<int>& parent2,
+                            std::vector<int>& offspring,
+                            std::mt19937& gen) {
     int n = parent1.size();
     if (n < 2) {
-        return parent1;
+        offspring = parent1;
+        return;
     }
-    std::vector<int> offspring(n, -1);
+    offspring.assign(n, -1);
     
     std::uniform_int_distribution<int> dist(0, n - 1);
-    int start = dist(rng);
-    int end = dist(rng);
+    int start = dist(gen);
+    int end = dist(gen);
     
     if (start > end) std::swap(start, end);
     
     // Use a boolean array for faster checking
-    std::vector<bool> in_offspring(n + 1, false);
+    ScratchArena& arena = ScratchArena::local();
+    ScratchArena::Scope scope(arena);
+    bool* in_offspring = arena.allocate<bool>(n + 1);
+    std::fill(in_offspring, in_offspring + n + 1, false);
     
     // Copy segment from parent1
     for (int i = start; i <= end; i++) {
@@ -371,11 +740,10 @@ std::vector<int> ICAHGS::orderCrossover(const std::vector<int>& parent1,
         }
         parent2_pos = (parent2_pos + 1) % n;
     }
-    
-    return offspring;
 }
 
-void ICAHGS::mutate(std::vector<int>& permutation, double mutationRate) {
+void ICAHGS::mutate(std::vector<int>& permutation, double mutationRate,
+                    std::mt19937& gen) {
     int n = permutation.size();
     if (n < 2) {
         return;
@@ -384,43 +752,24 @@ void ICAHGS::mutate(std::vector<int>& permutation, double mutationRate) {
     std::uniform_int_distribution<int> pos(0, n - 1);
     
     for (int i = 0; i < n; i++) {
-        if (prob(rng) < mutationRate) {
-            int j = pos(rng);
+        if (prob(gen) < mutationRate) {
+            int j = pos(gen);
             std::swap(permutation[i], permutation[j]);
         }
     }
 }
 
 void ICAHGS::updateParetoArchive(const Solution& solution) {
-    if (solution.systemCompletionTime >= INF) return;
-    
-    bool isDominated = false;
-    
-    // Remove solutions in the archive that are dominated by the new solution
-    paretoArchive.erase(std::remove_if(paretoArchive.begin(), paretoArchive.end(),
-        [&](const Solution& archiveSol) {
-            if (solution.dominates(archiveSol)) {
-                return true;
-            }
-            if (archiveSol.dominates(solution)) {
-                isDominated = true;
-            }
-            return false;
-        }),
-        paretoArchive.end());
-
-    if (!isDominated) {
-        paretoArchive.push_back(solution);
-    }
+    paretoArchive.insert(solution);
 }
 
 double ICAHGS::calculateEmpirePower(const Empire& empire) {
-    double impPower = 1.0 / (empire.imperialist.solution.paretoRank + 1.0);
+    double impPower = 1.0 / (population[empire.imperialist].solution.paretoRank + 1.0);
     
     if (!empire.colonies.empty()) {
         double avgColonyPower = 0;
-        for (const auto& colony : empire.colonies) {
-            avgColonyPower += 1.0 / (colony.solution.paretoRank + 1.0);
+        for (int colony : empire.colonies) {
+            avgColonyPower += 1.0 / (population[colony].solution.paretoRank + 1.0);
         }
         avgColonyPower /= empire.colonies.size();
         
@@ -96,6 +96,13 @@ bool InputReader::readInstance(const string& filename, Instance& instance) {
     instance.truckParams.timeIntervals.push_back(TimeInterval(0, 3600, 0.8));
     instance.truckParams.timeIntervals.push_back(TimeInterval(3600, 7200, 1.0));
     instance.truckParams.timeIntervals.push_back(TimeInterval(7200, 14400, 0.8));
+    instance.truckParams.compileSpeedProfile();
+    
+    // Precompute distance / drone flight time matrices (needs cruiseSpeed)
+    if (!instance.buildDistanceMatrix()) {
+        cout << "Instance too large for distance matrix, "
+             << "computing distances on the fly" << endl;
+    }
     
     return true;
 }
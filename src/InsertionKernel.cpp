@@ -0,0 +1,118 @@
+#include "InsertionKernel.h"
+#include "DataStructures.h"
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+namespace InsertionKernel {
+
+// Cùng công thức và thứ tự phép tính như Decoder::computeTruckInsertionDelta
+static inline double positionCost(const TruckRouteBatch& route,
+                                  const TruckInsertionCandidate& cand, int p) {
+    double toNew = cand.timeRow[route.nodes[p]];
+    double shift = toNew + cand.serviceTime + cand.timeRow[route.nodes[p + 1]] -
+                   route.prevToNext[p];
+    int downstream = route.size - p;
+    double newArrival = route.arrival[p - 1] + toNew + cand.serviceTime;
+    double deltaWT = newArrival + downstream * shift;
+    return 0.5 * shift + 0.5 * deltaWT;
+}
+
+BatchInsertion bestTruckPositionScalar(const TruckRouteBatch& route,
+                                       const TruckInsertionCandidate& cand) {
+    BatchInsertion best = {-1, INF};
+    for (int p = 1; p <= route.size; p++) {
+        double cost = positionCost(route, cand, p);
+        if (cost < best.cost) {
+            best.cost = cost;
+            best.position = p;
+        }
+    }
+    return best;
+}
+
+#ifdef __AVX2__
+BatchInsertion bestTruckPositionAVX2(const TruckRouteBatch& route,
+                                     const TruckInsertionCandidate& cand) {
+    int m = route.size;
+
+    const __m256d service = _mm256_set1_pd(cand.serviceTime);
+    const __m256d half = _mm256_set1_pd(0.5);
+    const __m256d size = _mm256_set1_pd(m);
+    const __m256d step = _mm256_set1_pd(4);
+    // Gather có mask (mọi lane bật) thay cho _mm256_i32gather_pd, tránh
+    // -Wmaybe-uninitialized từ avx2intrin.h
+    const __m256d allLanes = _mm256_castsi256_pd(_mm256_set1_epi64x(-1));
+
+    // Mỗi lane giữ vị trí tốt nhất (so sánh chặt) trong các vị trí của nó
+    __m256d position = _mm256_setr_pd(1, 2, 3, 4);
+    __m256d bestCost = _mm256_set1_pd(INF);
+    __m256d bestPosition = _mm256_set1_pd(-1);
+
+    int p = 1;
+    for (; p + 3 <= m; p += 4) {
+        __m128i prevIdx = _mm_loadu_si128(reinterpret_cast<const __m128i*>(route.nodes + p));
+        __m128i nextIdx = _mm_loadu_si128(reinterpret_cast<const __m128i*>(route.nodes + p + 1));
+        __m256d toNew = _mm256_mask_i32gather_pd(_mm256_setzero_pd(), cand.timeRow, prevIdx,
+                                                 allLanes, 8);
+        __m256d fromNew = _mm256_mask_i32gather_pd(_mm256_setzero_pd(), cand.timeRow, nextIdx,
+                                                   allLanes, 8);
+
+        __m256d shift = _mm256_sub_pd(
+            _mm256_add_pd(_mm256_add_pd(toNew, service), fromNew),
+            _mm256_loadu_pd(route.prevToNext + p));
+        __m256d downstream = _mm256_sub_pd(size, position);
+        __m256d newArrival = _mm256_add_pd(
+            _mm256_add_pd(_mm256_loadu_pd(route.arrival + p - 1), toNew), service);
+        __m256d deltaWT = _mm256_add_pd(newArrival, _mm256_mul_pd(downstream, shift));
+        __m256d cost = _mm256_add_pd(_mm256_mul_pd(half, shift), _mm256_mul_pd(half, deltaWT));
+
+        __m256d better = _mm256_cmp_pd(cost, bestCost, _CMP_LT_OQ);
+        bestCost = _mm256_blendv_pd(bestCost, cost, better);
+        bestPosition = _mm256_blendv_pd(bestPosition, position, better);
+        position = _mm256_add_pd(position, step);
+    }
+
+    // Gộp 4 lane: cost nhỏ nhất, hòa → vị trí nhỏ hơn
+    alignas(32) double laneCost[4];
+    alignas(32) double lanePosition[4];
+    _mm256_store_pd(laneCost, bestCost);
+    _mm256_store_pd(lanePosition, bestPosition);
+
+    BatchInsertion best = {-1, INF};
+    for (int lane = 0; lane < 4; lane++) {
+        if (lanePosition[lane] < 0) continue;
+        if (laneCost[lane] < best.cost ||
+            (laneCost[lane] == best.cost && lanePosition[lane] < best.position)) {
+            best.cost = laneCost[lane];
+            best.position = (int)lanePosition[lane];
+        }
+    }
+
+    // Phần đuôi (< 4 vị trí), vị trí đều lớn hơn nên so sánh chặt là đủ
+    for (; p <= m; p++) {
+        double cost = positionCost(route, cand, p);
+        if (cost < best.cost) {
+            best.cost = cost;
+            best.position = p;
+        }
+    }
+    return best;
+}
+#endif
+
+BatchInsertion bestTruckPosition(const TruckRouteBatch& route,
+                                 const TruckInsertionCandidate& cand) {
+#ifdef __AVX2__
+    // Route ngắn: phí gộp lane lớn hơn phần lợi
+    if (route.size >= AVX2_MIN_POSITIONS) {
+        return bestTruckPositionAVX2(route, cand);
+    }
+    return bestTruckPositionScalar(route, cand);
+#else
+    return bestTruckPositionScalar(route, cand);
+#endif
+}
+
+}  // namespace InsertionKernel
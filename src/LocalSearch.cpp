@@ -4,13 +4,32 @@
 #include <iostream> // Thêm để debug
 
 Solution LocalSearch::improve(const Solution& solution, int maxIterations) {
-    Solution current = solution;
-    Solution best = solution;
+    Solution result = solution;
+    improveInPlace(result, maxIterations);
+    return result;
+}
+
+void LocalSearch::improveInPlace(Solution& solution, int maxIterations) {
+    Solution& current = workingSolution;
+    RouteBufferPool::local().assign(current, solution);  // dùng lại bộ nhớ route của lần trước
+    for (auto& route : current.truckRoutes) {
+        route.customers.reserve(instance.getNumCustomers());
+    }
+    FlatSolution& best = bestSnapshot;
+    best.assign(solution);
     
-    tabuList.clear();
+    // Bỏ qua mọi tabu còn sót từ lần gọi trước
+    tabuClock += tabuTenure + tabuTenureRandom + 1;
+    customerIndex.build(current, instance.getNumCustomers());
+    if ((int)swapSeen.size() != instance.getNumCustomers() + 1) {
+        swapSeen.assign(instance.getNumCustomers() + 1, 0);
+        swapStamp = 0;
+    }
+    buildSlots(current);
     int iterWithoutImprovement = 0;
     
     for (int iter = 0; iter < maxIterations; iter++) {
+        tabuClock++;
         Move bestMove = findBestMove(current);
         
         if (bestMove.customer1 == -1) {
@@ -18,9 +37,9 @@ Solution LocalSearch::improve(const Solution& solution, int maxIterations) {
             break;
         }
         
-        // Apply move
-        Solution neighbor = applyMove(current, bestMove);
-        evaluator.evaluate(neighbor);
+        // Apply move (tại chỗ, chỉ move được chọn)
+        applyMove(current, bestMove);
+        buildSlots(current);
         
         // Update tabu list
         updateTabuList(bestMove.customer1, static_cast<int>(bestMove.type));
@@ -29,119 +48,242 @@ Solution LocalSearch::improve(const Solution& solution, int maxIterations) {
         }
         
         // Check if improved
-        if (neighbor.dominates(best)) {
-            best = neighbor;
+        if (current.dominates(best)) {
+            best.assign(current);
             iterWithoutImprovement = 0;
         } else {
             iterWithoutImprovement++;
         }
         
-        current = neighbor;
-        
         // Early stopping
         if (iterWithoutImprovement > 20) {
             break;
         }
     }
     
-    return best;
+    best.expandInto(solution);
 }
 
-LocalSearch::Move LocalSearch::findBestMove(const Solution& solution) {
-    Move bestMove;
-    bestMove.deltaCost = INF;
+// ==================== DELTA EVALUATION ENGINE ====================
+
+// Đánh giá lại mọi route, lưu vào slots và cập nhật objectives của solution
+// (cùng thứ tự cộng với SolutionEvaluator::evaluate → kết quả giống hệt)
+void LocalSearch::buildSlots(Solution& solution) {
+    slots.clear();
+    droneSlotEnd.assign(solution.droneRoutes.size(), 0);
     
-    // Collect all customers in solution
-    std::vector<int> allCustomers;
+    for (size_t truckId = 0; truckId < solution.truckRoutes.size(); truckId++) {
+        Route& route = solution.truckRoutes[truckId];
+        RouteSlot slot;
+        slot.type = 0;
+        slot.vehicleId = truckId;
+        slot.tripId = -1;
+        slot.eval = evaluateSequence(0, route.customers);
+        route.completionTime = slot.eval.completionTime;
+        route.totalWaitingTime = slot.eval.waitingTime;
+        slots.push_back(slot);
+    }
     
-    // From truck routes
-    for (const auto& route : solution.truckRoutes) {
-        for (int cust : route.customers) {
-            allCustomers.push_back(cust);
+    for (size_t droneId = 0; droneId < solution.droneRoutes.size(); droneId++) {
+        auto& trips = solution.droneRoutes[droneId];
+        for (size_t tripId = 0; tripId < trips.size(); tripId++) {
+            RouteSlot slot;
+            slot.type = 1;
+            slot.vehicleId = droneId;
+            slot.tripId = tripId;
+            slot.eval = evaluateSequence(1, trips[tripId].customers);
+            if (slot.eval.feasible) {
+                trips[tripId].completionTime = slot.eval.completionTime;
+                trips[tripId].totalWaitingTime = slot.eval.waitingTime;
+            }
+            slots.push_back(slot);
         }
+        droneSlotEnd[droneId] = slots.size();
     }
     
-    // From drone routes
-    for (const auto& trips : solution.droneRoutes) {
-        for (const auto& trip : trips) {
-            for (int cust : trip.customers) {
-                allCustomers.push_back(cust);
+    RouteEval none;
+    neighbourObjectives(-1, none, -1, none, -1, none,
+                        solution.systemCompletionTime, solution.totalSampleWaitingTime);
+}
+
+const std::vector<int>& LocalSearch::slotCustomers(const Solution& solution, int slot) const {
+    const RouteSlot& s = slots[slot];
+    if (s.type == 0) return solution.truckRoutes[s.vehicleId].customers;
+    return solution.droneRoutes[s.vehicleId][s.tripId].customers;
+}
+
+LocalSearch::RouteEval LocalSearch::evaluateSequence(int type, const std::vector<int>& customers) {
+    RouteEval eval;
+    if (type == 0) {
+        evaluator.evaluateTruckSequence(customers.data(), customers.size(),
+                                        eval.completionTime, eval.waitingTime);
+        eval.feasible = true;
+    } else {
+        eval.feasible = evaluator.evaluateDroneSequence(customers.data(), customers.size(),
+                                                        eval.completionTime, eval.waitingTime);
+    }
+    return eval;
+}
+
+// Objectives của láng giềng: slots giữ nguyên, trừ slotA/slotB được thay bằng
+// a/b và (nếu extraDrone >= 0) một trip mới của drone đó được thêm vào cuối.
+void LocalSearch::neighbourObjectives(int slotA, const RouteEval& a,
+                                      int slotB, const RouteEval& b,
+                                      int extraDrone, const RouteEval& extra,
+                                      double& completionTime, double& waitingTime) const {
+    double maxCompletionTime = 0;
+    double totalWaiting = 0;
+    int numSlots = slots.size();
+    int extraAt = (extraDrone >= 0) ? droneSlotEnd[extraDrone] : -1;
+    
+    for (int s = 0; s <= numSlots; s++) {
+        if (s == extraAt) {
+            if (!extra.feasible) {
+                completionTime = INF;
+                waitingTime = INF;
+                return;
             }
+            maxCompletionTime = std::max(maxCompletionTime, extra.completionTime);
+            totalWaiting += extra.waitingTime;
+        }
+        if (s == numSlots) break;
+        
+        const RouteEval& r = (s == slotA) ? a : (s == slotB) ? b : slots[s].eval;
+        if (!r.feasible) {
+            // Infeasible route
+            completionTime = INF;
+            waitingTime = INF;
+            return;
+        }
+        maxCompletionTime = std::max(maxCompletionTime, r.completionTime);
+        totalWaiting += r.waitingTime;
+    }
+    
+    completionTime = maxCompletionTime;
+    waitingTime = totalWaiting;
+}
+
+void LocalSearch::considerMove(const Solution& solution, const Move& move,
+                               double completionTime, double waitingTime,
+                               Move& bestMove) {
+    double delta = calculateDelta(solution, completionTime, waitingTime);
+    
+    if (delta < bestMove.deltaCost && completionTime < INF) {
+        bestMove = move;
+        bestMove.deltaCost = delta;
+    }
+}
+
+// Không tạo Solution láng giềng: chỉ dựng lại dãy customers của 1-2 route bị
+// ảnh hưởng trong buffer tái sử dụng, các route khác đọc từ slots.
+// Nếu instance có candidate lists (numNeighbors > 0), chỉ thử các move đặt
+// customer cạnh một trong k láng giềng gần nhất của nó.
+LocalSearch::Move LocalSearch::findBestMove(const Solution& solution) {
+    Move bestMove;
+    bestMove.deltaCost = INF;
+    
+    RouteEval none;
+    double ct, wt;
+    bool granular = instance.numNeighbors > 0;
+    
+    // Vị trí hiện tại của mọi customer (slot, pos)
+    customerSlots.clear();
+    for (int s = 0; s < (int)slots.size(); s++) {
+        for (int p = 0; p < (int)slotCustomers(solution, s).size(); p++) {
+            customerSlots.push_back(std::make_pair(s, p));
         }
     }
     
     // Try RELOCATE moves
-    for (int cust : allCustomers) {
-        if (isTabu(cust, Move::RELOCATE)) continue;
+    for (int s = 0; s < (int)slots.size(); s++) {
+        const auto& from = slotCustomers(solution, s);
         
-        // Try moving to different positions in truck routes
-        for (size_t truckId = 0; truckId < solution.truckRoutes.size(); truckId++) {
-            const auto& route = solution.truckRoutes[truckId];
+        for (int p = 0; p < (int)from.size(); p++) {
+            int cust = from[p];
+            if (isTabu(cust, Move::RELOCATE)) continue;
+            
+            // Route nguồn sau khi bỏ cust: dùng chung cho mọi vị trí đích
+            sourceBuffer.assign(from.begin(), from.end());
+            sourceBuffer.erase(sourceBuffer.begin() + p);
+            RouteEval source = evaluateSequence(slots[s].type, sourceBuffer);
             
-            for (size_t pos = 0; pos <= route.customers.size(); pos++) {
-                // Create neighbor
-                Move move;
-                move.type = Move::RELOCATE;
-                move.customer1 = cust;
+            Move move;
+            move.type = Move::RELOCATE;
+            move.customer1 = cust;
+            move.fromRoute = s;
+            move.fromPos = p;
+            
+            // Try moving to different positions in truck routes
+            collectRelocateTargets(solution, cust, s, p, granular);
+            for (const auto& target : relocateTargets) {
+                int truckId = target.first;
+                int pos = target.second;
                 move.toRoute = truckId;
                 move.toPos = pos;
                 
-                Solution neighbor = applyMove(solution, move);
-                evaluator.evaluate(neighbor);
-                
-                double delta = calculateDelta(solution, neighbor);
-                
-                if (delta < bestMove.deltaCost && neighbor.systemCompletionTime < INF) {
-                    bestMove = move;
-                    bestMove.deltaCost = delta;
+                if (slots[s].type == 0 && slots[s].vehicleId == truckId) {
+                    // Bỏ khỏi route rồi chèn lại (vị trí bị chặn ở cuối route)
+                    bufferA.assign(sourceBuffer.begin(), sourceBuffer.end());
+                    bufferA.insert(bufferA.begin() + std::min(pos, (int)sourceBuffer.size()), cust);
+                    RouteEval eval = evaluateSequence(0, bufferA);
+                    neighbourObjectives(s, eval, -1, none, -1, none, ct, wt);
+                } else {
+                    const auto& route = solution.truckRoutes[truckId];
+                    bufferA.assign(route.customers.begin(), route.customers.end());
+                    bufferA.insert(bufferA.begin() + pos, cust);
+                    RouteEval eval = evaluateSequence(0, bufferA);
+                    neighbourObjectives(s, source, truckId, eval, -1, none, ct, wt);
                 }
-            }
-        }
-        
-        // Try moving to drone routes (if flexible customer)
-        const Customer& customer = instance.customers[cust - 1];
-        if (!customer.isStaffOnly) {
-            for (size_t droneId = 0; droneId < solution.droneRoutes.size(); droneId++) {
-                // Try adding to new trip
-                Move move;
-                move.type = Move::RELOCATE;
-                move.customer1 = cust;
-                move.toRoute = droneId + 1000;  // Offset to distinguish from truck
                 
-                Solution neighbor = applyMove(solution, move);
-                evaluator.evaluate(neighbor);
-                
-                double delta = calculateDelta(solution, neighbor);
+                considerMove(solution, move, ct, wt, bestMove);
+            }
+            
+            // Try moving to drone routes (if flexible customer)
+            const Customer& customer = instance.customers[cust - 1];
+            if (!customer.isStaffOnly) {
+                bufferA.assign(1, cust);
+                RouteEval newTrip = evaluateSequence(1, bufferA);
                 
-                if (delta < bestMove.deltaCost && neighbor.systemCompletionTime < INF) {
-                    bestMove = move;
-                    bestMove.deltaCost = delta;
+                for (size_t droneId = 0; droneId < solution.droneRoutes.size(); droneId++) {
+                    // Try adding to new trip
+                    move.toRoute = droneId + 1000;  // Offset to distinguish from truck
+                    move.toPos = -1;
+                    
+                    neighbourObjectives(s, source, -1, none, droneId, newTrip, ct, wt);
+                    considerMove(solution, move, ct, wt, bestMove);
                 }
             }
         }
     }
     
     // Try SWAP moves (simplified version)
-    for (size_t i = 0; i < allCustomers.size(); i++) {
-        for (size_t j = i + 1; j < allCustomers.size(); j++) {
-            int cust1 = allCustomers[i];
-            int cust2 = allCustomers[j];
-            
-            if (isTabu(cust1, Move::SWAP) || isTabu(cust2, Move::SWAP)) continue;
-            
-            Move move;
-            move.type = Move::SWAP;
-            move.customer1 = cust1;
-            move.customer2 = cust2;
-            
-            Solution neighbor = applyMove(solution, move);
-            evaluator.evaluate(neighbor);
-            
-            double delta = calculateDelta(solution, neighbor);
+    for (size_t i = 0; i < customerSlots.size(); i++) {
+        int slot1 = customerSlots[i].first, pos1 = customerSlots[i].second;
+        
+        if (!granular) {
+            for (size_t j = i + 1; j < customerSlots.size(); j++) {
+                scoreSwap(solution, slot1, pos1,
+                          customerSlots[j].first, customerSlots[j].second, bestMove);
+            }
+            continue;
+        }
+        
+        // Đổi cust1 với láng giềng trước/sau của mỗi w ∈ N(cust1) → cust1 nằm cạnh w
+        int cust1 = slotCustomers(solution, slot1)[pos1];
+        const int* neighbors = instance.getNeighbors(cust1);
+        swapStamp++;
+        for (int r = 0; r < instance.numNeighbors; r++) {
+            int w = neighbors[r];
+            const CustomerLocation& locW = customerIndex[w];
+            int slotW = slotOf(locW), posW = locW.position;
+            const auto& routeW = slotCustomers(solution, slotW);
             
-            if (delta < bestMove.deltaCost && neighbor.systemCompletionTime < INF) {
-                bestMove = move;
-                bestMove.deltaCost = delta;
+            for (int posV : {posW - 1, posW + 1}) {
+                if (posV < 0 || posV >= (int)routeW.size()) continue;
+                int v = routeW[posV];
+                if (v == cust1 || swapSeen[v] == swapStamp) continue;
+                swapSeen[v] = swapStamp;
+                scoreSwap(solution, slot1, pos1, slotW, posV, bestMove);
             }
         }
     }
@@ -149,39 +291,97 @@ LocalSearch::Move LocalSearch::findBestMove(const Solution& solution) {
     return bestMove;
 }
 
-Solution LocalSearch::applyMove(const Solution& solution, const Move& move) {
-    Solution result = solution;
+void LocalSearch::scoreSwap(const Solution& solution, int slot1, int pos1,
+                            int slot2, int pos2, Move& bestMove) {
+    const auto& route1 = slotCustomers(solution, slot1);
+    const auto& route2 = slotCustomers(solution, slot2);
+    int cust1 = route1[pos1];
+    int cust2 = route2[pos2];
     
-    if (move.type == Move::RELOCATE) {
-        // Remove customer from current position
-        bool found = false;
-        
-        // Try truck routes
-        for (auto& route : result.truckRoutes) {
-            auto it = std::find(route.customers.begin(), route.customers.end(), 
-                              move.customer1);
-            if (it != route.customers.end()) {
-                route.customers.erase(it);
-                found = true;
-                break;
+    if (isTabu(cust1, Move::SWAP) || isTabu(cust2, Move::SWAP)) return;
+    
+    Move move;
+    move.type = Move::SWAP;
+    move.customer1 = cust1;
+    move.customer2 = cust2;
+    
+    RouteEval none;
+    double ct, wt;
+    if (slot1 == slot2) {
+        bufferA.assign(route1.begin(), route1.end());
+        std::swap(bufferA[pos1], bufferA[pos2]);
+        RouteEval r = evaluateSequence(slots[slot1].type, bufferA);
+        neighbourObjectives(slot1, r, -1, none, -1, none, ct, wt);
+    } else {
+        bufferA.assign(route1.begin(), route1.end());
+        bufferA[pos1] = cust2;
+        bufferB.assign(route2.begin(), route2.end());
+        bufferB[pos2] = cust1;
+        RouteEval r1 = evaluateSequence(slots[slot1].type, bufferA);
+        RouteEval r2 = evaluateSequence(slots[slot2].type, bufferB);
+        neighbourObjectives(slot1, r1, slot2, r2, -1, none, ct, wt);
+    }
+    
+    considerMove(solution, move, ct, wt, bestMove);
+}
+
+// Các vị trí (truck, pos) để thử RELOCATE cust (đang ở slot s, vị trí p).
+// pos theo quy ước của applyMove: nếu cùng route thì tính sau khi đã bỏ cust.
+void LocalSearch::collectRelocateTargets(const Solution& solution, int cust,
+                                         int s, int p, bool granular) {
+    relocateTargets.clear();
+    int numTrucks = solution.truckRoutes.size();
+    
+    if (!granular) {
+        for (int truckId = 0; truckId < numTrucks; truckId++) {
+            int size = solution.truckRoutes[truckId].size();
+            for (int pos = 0; pos <= size; pos++) {
+                relocateTargets.push_back(std::make_pair(truckId, pos));
             }
         }
+        return;
+    }
+    
+    // Ngay trước / sau mỗi láng giềng w đang nằm trên truck route
+    const int* neighbors = instance.getNeighbors(cust);
+    for (int r = 0; r < instance.numNeighbors; r++) {
+        int w = neighbors[r];
+        const CustomerLocation& locW = customerIndex[w];
+        if (locW.vehicleType != 0) continue;
         
-        // Try drone routes
-        if (!found) {
-            for (auto& trips : result.droneRoutes) {
-                for (auto& trip : trips) {
-                    auto it = std::find(trip.customers.begin(), trip.customers.end(),
-                                      move.customer1);
-                    if (it != trip.customers.end()) {
-                        trip.customers.erase(it);
-                        found = true;
-                        break; // Dừng ngay khi tìm thấy và xóa
-                    }
-                }
-                if (found) break; // Dừng vòng lặp ngoài nếu đã tìm thấy
-            }
+        int truckId = locW.vehicleId;
+        int posW = locW.position;
+        if (slotOf(locW) == s && p < posW) posW--;  // w dịch lên sau khi bỏ cust
+        
+        relocateTargets.push_back(std::make_pair(truckId, posW));
+        relocateTargets.push_back(std::make_pair(truckId, posW + 1));
+    }
+    
+    // Truck rỗng: không có láng giềng nào nhưng vẫn phải cho phép mở route
+    for (int truckId = 0; truckId < numTrucks; truckId++) {
+        if (solution.truckRoutes[truckId].isEmpty()) {
+            relocateTargets.push_back(std::make_pair(truckId, 0));
         }
+    }
+    
+    std::sort(relocateTargets.begin(), relocateTargets.end());
+    relocateTargets.erase(std::unique(relocateTargets.begin(), relocateTargets.end()),
+                          relocateTargets.end());
+}
+
+// Áp dụng move tại chỗ; tìm customer qua customerIndex (O(1)) và cập nhật
+// index cho các route bị thay đổi.
+void LocalSearch::applyMove(Solution& result, const Move& move) {
+    if (move.type == Move::RELOCATE) {
+        // Remove customer from current position
+        CustomerLocation from = customerIndex[move.customer1];
+        if (!from.isServed()) return;
+        
+        Route& source = CustomerIndex::routeAt(result, from);
+        result.solutionHash ^= linkDeltaAt(routeKey(from), source.customers, from.position);
+        source.customers.erase(source.customers.begin() + from.position);
+        customerIndex.remove(move.customer1);
+        customerIndex.reindexRoute(result, from.vehicleType, from.vehicleId, from.tripId);
         
         // Insert at new position
         if (move.toRoute < 1000) {
@@ -194,92 +394,83 @@ Solution LocalSearch::applyMove(const Solution& solution, const Move& move) {
             target_customers.insert(
                 target_customers.begin() + insert_pos,
                 move.customer1);
+            result.solutionHash ^= linkDeltaAt(
+                SolutionHasher::truckRouteKey(move.toRoute), target_customers, insert_pos);
+            customerIndex.reindexRoute(result, 0, move.toRoute);
         } else {
             // Insert into drone route (new trip)
             int droneId = move.toRoute - 1000;
-            Route newTrip;
-            newTrip.customers.push_back(move.customer1);
-            result.droneRoutes[droneId].push_back(newTrip);
+            RouteBufferPool::local().addTrip(result.droneRoutes[droneId])
+                .customers.push_back(move.customer1);
+            int tripId = result.droneRoutes[droneId].size() - 1;
+            result.solutionHash ^= hasher.linkDelta(
+                SolutionHasher::droneRouteKey(droneId, tripId), 0, move.customer1, 0);
+            customerIndex.reindexRoute(result, 1, droneId, tripId);
         }
         
     } else if (move.type == Move::SWAP) {
-        // --- FIX: Sử dụng index thay vì con trỏ để tránh lỗi bộ nhớ ---
-        int route_type1 = -1, route_idx1 = -1, trip_idx1 = -1, cust_idx1 = -1;
-        int route_type2 = -1, route_idx2 = -1, trip_idx2 = -1, cust_idx2 = -1;
-
-        // Tìm vị trí của customer1
-        for (size_t i = 0; i < result.truckRoutes.size() && route_type1 == -1; ++i) {
-            for (size_t j = 0; j < result.truckRoutes[i].customers.size(); ++j) {
-                if (result.truckRoutes[i].customers[j] == move.customer1) {
-                    route_type1 = 0; route_idx1 = i; cust_idx1 = j; break;
-                }
-            }
-        }
-        if (route_type1 == -1) {
-            for (size_t i = 0; i < result.droneRoutes.size() && route_type1 == -1; ++i) {
-                for (size_t j = 0; j < result.droneRoutes[i].size(); ++j) {
-                    for (size_t k = 0; k < result.droneRoutes[i][j].customers.size(); ++k) {
-                        if (result.droneRoutes[i][j].customers[k] == move.customer1) {
-                            route_type1 = 1; route_idx1 = i; trip_idx1 = j; cust_idx1 = k; break;
-                        }
-                    }
-                    if (route_type1 != -1) break;
-                }
-            }
-        }
-
-        // Tìm vị trí của customer2
-        for (size_t i = 0; i < result.truckRoutes.size() && route_type2 == -1; ++i) {
-            for (size_t j = 0; j < result.truckRoutes[i].customers.size(); ++j) {
-                if (result.truckRoutes[i].customers[j] == move.customer2) {
-                    route_type2 = 0; route_idx2 = i; cust_idx2 = j; break;
-                }
-            }
-        }
-        if (route_type2 == -1) {
-            for (size_t i = 0; i < result.droneRoutes.size() && route_type2 == -1; ++i) {
-                for (size_t j = 0; j < result.droneRoutes[i].size(); ++j) {
-                    for (size_t k = 0; k < result.droneRoutes[i][j].customers.size(); ++k) {
-                        if (result.droneRoutes[i][j].customers[k] == move.customer2) {
-                            route_type2 = 1; route_idx2 = i; trip_idx2 = j; cust_idx2 = k; break;
-                        }
-                    }
-                    if (route_type2 != -1) break;
-                }
-            }
-        }
-
+        CustomerLocation loc1 = customerIndex[move.customer1];
+        CustomerLocation loc2 = customerIndex[move.customer2];
+        
         // Thực hiện hoán đổi nếu tìm thấy cả hai
-        if (route_type1 != -1 && route_type2 != -1) {
-            int& cust1_ref = (route_type1 == 0) ? result.truckRoutes[route_idx1].customers[cust_idx1] : result.droneRoutes[route_idx1][trip_idx1].customers[cust_idx1];
-            int& cust2_ref = (route_type2 == 0) ? result.truckRoutes[route_idx2].customers[cust_idx2] : result.droneRoutes[route_idx2][trip_idx2].customers[cust_idx2];
-            std::swap(cust1_ref, cust2_ref);
+        if (loc1.isServed() && loc2.isServed()) {
+            auto& custs1 = CustomerIndex::routeAt(result, loc1).customers;
+            auto& custs2 = CustomerIndex::routeAt(result, loc2).customers;
+            int idx1 = loc1.position, idx2 = loc2.position;
+            result.solutionHash ^= hasher.swapDelta(
+                routeKey(loc1), idx1 > 0 ? custs1[idx1 - 1] : 0, move.customer1,
+                idx1 + 1 < (int)custs1.size() ? custs1[idx1 + 1] : 0,
+                routeKey(loc2), idx2 > 0 ? custs2[idx2 - 1] : 0, move.customer2,
+                idx2 + 1 < (int)custs2.size() ? custs2[idx2 + 1] : 0);
+            std::swap(custs1[idx1], custs2[idx2]);
+            
+            // Hai customer đổi chỗ cho nhau
+            customerIndex.locations[move.customer1] = loc2;
+            customerIndex.locations[move.customer2] = loc1;
         }
     }
-    
-    return result;
+}
+
+uint64_t LocalSearch::routeKey(const CustomerLocation& loc) {
+    return (loc.vehicleType == 0) ? SolutionHasher::truckRouteKey(loc.vehicleId)
+                                  : SolutionHasher::droneRouteKey(loc.vehicleId, loc.tripId);
+}
+
+int LocalSearch::slotOf(const CustomerLocation& loc) const {
+    if (loc.vehicleType == 0) return loc.vehicleId;
+    int firstTrip = (loc.vehicleId == 0) ? instance.numTrucks : droneSlotEnd[loc.vehicleId - 1];
+    return firstTrip + loc.tripId;
+}
+
+uint64_t LocalSearch::linkDeltaAt(uint64_t routeKey, const std::vector<int>& customers,
+                                  size_t pos) const {
+    int prev = (pos > 0) ? customers[pos - 1] : 0;
+    int next = (pos + 1 < customers.size()) ? customers[pos + 1] : 0;
+    return hasher.linkDelta(routeKey, prev, customers[pos], next);
 }
 
 bool LocalSearch::isTabu(int customer, int moveType) const {
-    return tabuList.find(std::make_pair(customer, moveType)) != tabuList.end();
+    return tabuUntil[customer * NUM_MOVE_TYPES + moveType] >= tabuClock;
 }
 
 void LocalSearch::updateTabuList(int customer, int moveType) {
-    tabuList.insert({customer, moveType});
-    
-    // Keep tabu list size limited
-    if (tabuList.size() > static_cast<size_t>(tabuTenure)) {
-        tabuList.erase(tabuList.begin());
+    int tenure = tabuTenure;
+    if (tabuTenureRandom > 0) {
+        std::uniform_int_distribution<int> extra(0, tabuTenureRandom);
+        tenure += extra(tabuRng);
     }
+    // Cấm trong `tenure` iteration tiếp theo
+    tabuUntil[customer * NUM_MOVE_TYPES + moveType] = tabuClock + tenure;
 }
 
 double LocalSearch::calculateDelta(const Solution& current, 
-                                   const Solution& neighbor) {
+                                   double neighborCompletionTime,
+                                   double neighborWaitingTime) {
     // Weighted sum of objectives
     double w1 = 0.5, w2 = 0.5;
     
-    double delta1 = neighbor.systemCompletionTime - current.systemCompletionTime;
-    double delta2 = neighbor.totalSampleWaitingTime - current.totalSampleWaitingTime;
+    double delta1 = neighborCompletionTime - current.systemCompletionTime;
+    double delta2 = neighborWaitingTime - current.totalSampleWaitingTime;
     
     return w1 * delta1 + w2 * delta2;
 }
@@ -0,0 +1,263 @@
+#include "MigrationChannel.h"
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <poll.h>
+#include <unistd.h>
+#include <cstring>
+
+namespace {
+
+const uint32_t MESSAGE_MAGIC = 0x49434148;  // "ICAH"
+const size_t MAX_DATAGRAM = 1 << 18;
+
+struct MessageHeader {
+    uint32_t magic;
+    uint32_t type;
+    int32_t sender;
+};
+
+// Đọc tuần tự payload, báo lỗi khi vượt quá kích thước gói
+struct PayloadReader {
+    const char* data;
+    size_t size;
+    size_t offset;
+
+    bool readInt(int32_t& value) {
+        if (offset + sizeof(value) > size) return false;
+        memcpy(&value, data + offset, sizeof(value));
+        offset += sizeof(value);
+        return true;
+    }
+
+    bool readDouble(double& value) {
+        if (offset + sizeof(value) > size) return false;
+        memcpy(&value, data + offset, sizeof(value));
+        offset += sizeof(value);
+        return true;
+    }
+
+    bool readRoute(Route& route) {
+        int32_t length;
+        if (!readInt(length) || length < 0) return false;
+        if (offset + (size_t)length * sizeof(int32_t) > size) return false;
+        route.customers.resize(length);
+        for (int32_t i = 0; i < length; i++) {
+            readInt(route.customers[i]);
+        }
+        return true;
+    }
+};
+
+} // namespace
+
+MigrationChannel::MigrationChannel(const std::string& dir, const std::string& runId,
+                                   int rank, int numProcs)
+    : dir(dir), runId(runId), rank(rank), numProcs(numProcs), fd(-1) {}
+
+MigrationChannel::~MigrationChannel() {
+    close();
+}
+
+std::string MigrationChannel::socketPath(int targetRank) const {
+    return dir + "/icahgs." + runId + "." + std::to_string(targetRank) + ".sock";
+}
+
+bool MigrationChannel::open() {
+    std::string path = socketPath(rank);
+    sockaddr_un addr;
+    if (path.size() >= sizeof(addr.sun_path)) return false;
+
+    fd = socket(AF_UNIX, SOCK_DGRAM, 0);
+    if (fd < 0) return false;
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, path.c_str());
+
+    unlink(path.c_str());  // file còn sót lại từ lần chạy bị kill
+    if (bind(fd, (sockaddr*)&addr, sizeof(addr)) < 0) {
+        ::close(fd);
+        fd = -1;
+        return false;
+    }
+    return true;
+}
+
+void MigrationChannel::close() {
+    if (fd < 0) return;
+    ::close(fd);
+    fd = -1;
+    unlink(socketPath(rank).c_str());
+}
+
+void MigrationChannel::removePeerSockets() {
+    for (int peer = 0; peer < numProcs; peer++) {
+        unlink(socketPath(peer).c_str());
+    }
+}
+
+void MigrationChannel::beginMessage(MessageType type) {
+    MessageHeader header = {MESSAGE_MAGIC, type, rank};
+    buffer.resize(sizeof(header));
+    memcpy(buffer.data(), &header, sizeof(header));
+}
+
+void MigrationChannel::appendInt(int32_t value) {
+    size_t offset = buffer.size();
+    buffer.resize(offset + sizeof(value));
+    memcpy(buffer.data() + offset, &value, sizeof(value));
+}
+
+void MigrationChannel::appendDouble(double value) {
+    size_t offset = buffer.size();
+    buffer.resize(offset + sizeof(value));
+    memcpy(buffer.data() + offset, &value, sizeof(value));
+}
+
+void MigrationChannel::appendRoute(const RouteView& route) {
+    appendInt(route.size());
+    for (int cust : route) {
+        appendInt(cust);
+    }
+}
+
+bool MigrationChannel::sendTo(int targetRank, bool blocking) {
+    if (fd < 0) return false;
+
+    sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    std::string path = socketPath(targetRank);
+    strcpy(addr.sun_path, path.c_str());
+
+    int flags = blocking ? 0 : MSG_DONTWAIT;
+    ssize_t sent = sendto(fd, buffer.data(), buffer.size(), flags,
+                          (sockaddr*)&addr, sizeof(addr));
+    // EAGAIN: bên nhận đầy; ENOENT / ECONNREFUSED: bên nhận chưa mở hoặc đã thoát
+    return sent == (ssize_t)buffer.size();
+}
+
+int MigrationChannel::receive(MessageType expected, int timeoutMs) {
+    if (fd < 0) return -1;
+    buffer.resize(MAX_DATAGRAM);
+
+    while (true) {
+        if (timeoutMs > 0) {
+            pollfd pfd = {fd, POLLIN, 0};
+            if (poll(&pfd, 1, timeoutMs) <= 0) return -1;
+        }
+
+        ssize_t size = recv(fd, buffer.data(), buffer.size(), MSG_DONTWAIT);
+        if (size < 0) return -1;
+
+        // Bỏ qua gói lạ hoặc sai loại
+        MessageHeader header;
+        if ((size_t)size < sizeof(header)) continue;
+        memcpy(&header, buffer.data(), sizeof(header));
+        if (header.magic != MESSAGE_MAGIC || header.type != expected) continue;
+
+        return size;
+    }
+}
+
+bool MigrationChannel::sendMigrant(const std::vector<int>& permutation) {
+    beginMessage(MIGRANT);
+    for (int cust : permutation) {
+        appendInt(cust);
+    }
+    return sendTo((rank + 1) % numProcs, false);
+}
+
+int MigrationChannel::receiveMigrants(std::vector<std::vector<int>>& migrants,
+                                      int maxCount) {
+    int count = 0;
+    while (count < maxCount) {
+        int size = receive(MIGRANT, 0);
+        if (size < 0) break;
+
+        PayloadReader reader = {buffer.data(), (size_t)size, sizeof(MessageHeader)};
+        std::vector<int> permutation;
+        int32_t cust;
+        while (reader.readInt(cust)) {
+            permutation.push_back(cust);
+        }
+        migrants.push_back(std::move(permutation));
+        count++;
+    }
+    return count;
+}
+
+bool MigrationChannel::sendSolution(const FlatSolution& solution, bool blocking) {
+    beginMessage(ARCHIVE);
+    appendDouble(solution.systemCompletionTime);
+    appendDouble(solution.totalSampleWaitingTime);
+
+    appendInt(solution.numTrucks);
+    for (int truckId = 0; truckId < solution.numTrucks; truckId++) {
+        appendRoute(solution.truckRoute(truckId));
+    }
+    appendInt(solution.numDrones);
+    for (int droneId = 0; droneId < solution.numDrones; droneId++) {
+        int first, last;
+        solution.droneTripRange(droneId, first, last);
+        appendInt(last - first);
+        for (int r = first; r < last; r++) {
+            appendRoute(solution.route(r));
+        }
+    }
+
+    if (buffer.size() > MAX_DATAGRAM) return false;
+    return sendTo(numProcs, blocking);
+}
+
+int MigrationChannel::sendArchive(const std::vector<FlatSolution>& archive, bool blocking) {
+    int sent = 0;
+    for (const auto& solution : archive) {
+        if (sendSolution(solution, blocking)) sent++;
+    }
+    return sent;
+}
+
+bool MigrationChannel::receiveArchive(Solution& solution, int timeoutMs) {
+    while (true) {
+        int size = receive(ARCHIVE, timeoutMs);
+        if (size < 0) return false;
+        if (decodeSolution(buffer.data() + sizeof(MessageHeader),
+                           size - sizeof(MessageHeader), solution)) {
+            return true;
+        }
+    }
+}
+
+bool MigrationChannel::decodeSolution(const char* data, size_t size, Solution& solution) {
+    PayloadReader reader = {data, size, 0};
+    solution = Solution();
+
+    int32_t numTrucks, numDrones;
+    if (!reader.readDouble(solution.systemCompletionTime) ||
+        !reader.readDouble(solution.totalSampleWaitingTime) ||
+        !reader.readInt(numTrucks) || numTrucks < 0 || (size_t)numTrucks > size) {
+        return false;
+    }
+
+    solution.truckRoutes.resize(numTrucks);
+    for (auto& route : solution.truckRoutes) {
+        if (!reader.readRoute(route)) return false;
+    }
+
+    if (!reader.readInt(numDrones) || numDrones < 0 || (size_t)numDrones > size) {
+        return false;
+    }
+    solution.droneRoutes.resize(numDrones);
+    for (auto& trips : solution.droneRoutes) {
+        int32_t numTrips;
+        if (!reader.readInt(numTrips) || numTrips < 0 || (size_t)numTrips > size) {
+            return false;
+        }
+        trips.resize(numTrips);
+        for (auto& trip : trips) {
+            if (!reader.readRoute(trip)) return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,94 @@
+#include "ObjectiveStore.h"
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+void ObjectiveStore::clear() {
+    completionTimes.clear();
+    waitingTimes.clear();
+}
+
+void ObjectiveStore::reserve(size_t n) {
+    completionTimes.reserve(n);
+    waitingTimes.reserve(n);
+}
+
+int ObjectiveStore::add(double completionTime, double waitingTime) {
+    completionTimes.push_back(completionTime);
+    waitingTimes.push_back(waitingTime);
+    return completionTimes.size() - 1;
+}
+
+void ObjectiveStore::set(size_t slot, double completionTime, double waitingTime) {
+    completionTimes[slot] = completionTime;
+    waitingTimes[slot] = waitingTime;
+}
+
+void ObjectiveStore::insert(size_t pos, double completionTime, double waitingTime) {
+    completionTimes.insert(completionTimes.begin() + pos, completionTime);
+    waitingTimes.insert(waitingTimes.begin() + pos, waitingTime);
+}
+
+void ObjectiveStore::erase(size_t first, size_t last) {
+    completionTimes.erase(completionTimes.begin() + first, completionTimes.begin() + last);
+    waitingTimes.erase(waitingTimes.begin() + first, waitingTimes.begin() + last);
+}
+
+size_t ObjectiveStore::weaklyDominatedRun(double ct, double wt, size_t begin) const {
+    return DominanceKernels::weaklyDominatedRun(completionTimes.data() + begin,
+                                                waitingTimes.data() + begin,
+                                                size() - begin, ct, wt);
+}
+
+// === DominanceKernels ===
+
+size_t DominanceKernels::weaklyDominatedRunScalar(const double* cts, const double* wts,
+                                                  size_t count, double ct, double wt) {
+    size_t i = 0;
+    while (i < count && ct <= cts[i] && wt <= wts[i]) i++;
+    return i;
+}
+
+#ifdef __AVX2__
+size_t DominanceKernels::weaklyDominatedRunAVX2(const double* cts, const double* wts,
+                                                size_t count, double ct, double wt) {
+    size_t i = 0;
+    __m256d vct = _mm256_set1_pd(ct);
+    __m256d vwt = _mm256_set1_pd(wt);
+    for (; i + 4 <= count; i += 4) {
+        __m256d okCt = _mm256_cmp_pd(vct, _mm256_loadu_pd(cts + i), _CMP_LE_OQ);
+        __m256d okWt = _mm256_cmp_pd(vwt, _mm256_loadu_pd(wts + i), _CMP_LE_OQ);
+        int mask = _mm256_movemask_pd(_mm256_and_pd(okCt, okWt));
+        if (mask != 0xF) return i + __builtin_ctz(~mask);
+    }
+    return i + weaklyDominatedRunScalar(cts + i, wts + i, count - i, ct, wt);
+}
+#endif
+
+#ifdef __SSE2__
+size_t DominanceKernels::weaklyDominatedRunSSE2(const double* cts, const double* wts,
+                                                size_t count, double ct, double wt) {
+    size_t i = 0;
+    __m128d vct = _mm_set1_pd(ct);
+    __m128d vwt = _mm_set1_pd(wt);
+    for (; i + 2 <= count; i += 2) {
+        __m128d okCt = _mm_cmple_pd(vct, _mm_loadu_pd(cts + i));
+        __m128d okWt = _mm_cmple_pd(vwt, _mm_loadu_pd(wts + i));
+        int mask = _mm_movemask_pd(_mm_and_pd(okCt, okWt));
+        if (mask != 0x3) return i + __builtin_ctz(~mask);
+    }
+    return i + weaklyDominatedRunScalar(cts + i, wts + i, count - i, ct, wt);
+}
+#endif
+
+size_t DominanceKernels::weaklyDominatedRun(const double* cts, const double* wts,
+                                            size_t count, double ct, double wt) {
+#if defined(__AVX2__)
+    return weaklyDominatedRunAVX2(cts, wts, count, ct, wt);
+#elif defined(__SSE2__)
+    return weaklyDominatedRunSSE2(cts, wts, count, ct, wt);
+#else
+    return weaklyDominatedRunScalar(cts, wts, count, ct, wt);
+#endif
+}
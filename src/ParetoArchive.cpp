@@ -0,0 +1,77 @@
+#include "ParetoArchive.h"
+#include <algorithm>
+
+bool ParetoArchive::insert(const Solution& solution) {
+    int slot = acquireSlot(solution.systemCompletionTime, solution.totalSampleWaitingTime);
+    if (slot < 0) return false;
+    payloads[slot].assign(solution);  // tái sử dụng bộ nhớ của slot cũ
+    return true;
+}
+
+bool ParetoArchive::insert(const FlatSolution& solution) {
+    int slot = acquireSlot(solution.systemCompletionTime, solution.totalSampleWaitingTime);
+    if (slot < 0) return false;
+    payloads[slot] = solution;
+    return true;
+}
+
+int ParetoArchive::acquireSlot(double ct, double wt) {
+    if (ct >= INF) return -1;
+
+    // Phần tử đầu tiên có completion time >= ct
+    const double* cts = objectiveStore.completionData();
+    const double* wts = objectiveStore.waitingData();
+    size_t count = objectiveStore.size();
+    size_t first = std::lower_bound(cts, cts + count, ct) - cts;
+
+    // Phần tử đứng trước có completion time < ct và waiting time nhỏ nhất trong
+    // số đó; phần tử tại first (nếu cùng ct) cũng có thể trội
+    if (first > 0 && wts[first - 1] <= wt) {
+        return -1;
+    }
+    if (first < count && cts[first] == ct && wts[first] <= wt) {
+        return -1;
+    }
+
+    // Các phần tử bị trội: liền nhau từ first
+    size_t last = first + objectiveStore.weaklyDominatedRun(ct, wt, first);
+    for (size_t i = first; i < last; i++) {
+        freeSlots.push_back(slots[i]);
+    }
+
+    int slot;
+    if (!freeSlots.empty()) {
+        slot = freeSlots.back();
+        freeSlots.pop_back();
+    } else {
+        slot = payloads.size();
+        payloads.emplace_back();
+    }
+
+    if (first != last) {
+        objectiveStore.set(first, ct, wt);
+        slots[first] = slot;
+        objectiveStore.erase(first + 1, last);
+        slots.erase(slots.begin() + first + 1, slots.begin() + last);
+    } else {
+        objectiveStore.insert(first, ct, wt);
+        slots.insert(slots.begin() + first, slot);
+    }
+    return slot;
+}
+
+void ParetoArchive::clear() {
+    objectiveStore.clear();
+    slots.clear();
+    payloads.clear();
+    freeSlots.clear();
+}
+
+std::vector<FlatSolution> ParetoArchive::toVector() const {
+    std::vector<FlatSolution> result;
+    result.reserve(slots.size());
+    for (int slot : slots) {
+        result.push_back(payloads[slot]);
+    }
+    return result;
+}
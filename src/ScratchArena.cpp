@@ -0,0 +1,49 @@
+#include "ScratchArena.h"
+#include <algorithm>
+#include <cstdint>
+
+ScratchArena& ScratchArena::local() {
+    static thread_local ScratchArena arena;
+    return arena;
+}
+
+void* ScratchArena::allocateBytes(size_t bytes, size_t alignment) {
+    while (currentBlock < blocks.size()) {
+        Block& block = blocks[currentBlock];
+        uintptr_t base = reinterpret_cast<uintptr_t>(block.data.get());
+        size_t aligned = ((base + offset + alignment - 1) & ~(uintptr_t)(alignment - 1)) - base;
+        if (aligned + bytes <= block.size) {
+            offset = aligned + bytes;
+            return block.data.get() + aligned;
+        }
+        // Block này hết chỗ → sang block kế tiếp (nếu có)
+        currentBlock++;
+        offset = 0;
+    }
+
+    size_t size = blocks.empty() ? INITIAL_BLOCK_SIZE : blocks.back().size * 2;
+    size = std::max(size, bytes + alignment);
+    blocks.push_back({std::unique_ptr<char[]>(new char[size]), size});
+    currentBlock = blocks.size() - 1;
+    offset = 0;
+    return allocateBytes(bytes, alignment);
+}
+
+void ScratchArena::reset() {
+    if (blocks.size() > 1) {
+        // Gộp thành một block đủ cho đỉnh vừa rồi
+        size_t total = capacity();
+        blocks.clear();
+        blocks.push_back({std::unique_ptr<char[]>(new char[total]), total});
+    }
+    currentBlock = 0;
+    offset = 0;
+}
+
+size_t ScratchArena::capacity() const {
+    size_t total = 0;
+    for (const auto& block : blocks) {
+        total += block.size;
+    }
+    return total;
+}
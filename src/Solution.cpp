@@ -1,10 +1,8 @@
 #include "Solution.h"
+#include "ObjectiveStore.h"
 #include <algorithm>
 #include <cmath>
 #include <vector> // Thêm thư viện này
-#include <random>      // ← THÊM (cho mt19937_64)
-#include <tuple>       // ← THÊM (cho make_tuple)
-#include <map>         // ← THÊM (cho map)
 #include <cstdint>
 
 using namespace std;
@@ -43,10 +41,46 @@ void SolutionEvaluator::evaluate(Solution& solution) {
     solution.totalSampleWaitingTime = totalWaiting;
 }
 
+// Cùng thứ tự cộng với evaluate(Solution&): trucks trước, rồi drone trips
+void SolutionEvaluator::evaluate(FlatSolution& solution) {
+    double maxCompletionTime = 0;
+    double totalWaiting = 0;
+    
+    for (auto& d : solution.routes) {
+        const int* customers = solution.customers.data() + d.offset;
+        if (d.vehicleType == 0) {
+            evaluateTruckSequence(customers, d.length, d.completionTime, d.totalWaitingTime);
+        } else if (!evaluateDroneSequence(customers, d.length,
+                                          d.completionTime, d.totalWaitingTime)) {
+            // Infeasible route
+            solution.systemCompletionTime = INF;
+            solution.totalSampleWaitingTime = INF;
+            return;
+        }
+        maxCompletionTime = max(maxCompletionTime, d.completionTime);
+        totalWaiting += d.totalWaitingTime;
+    }
+    
+    solution.systemCompletionTime = maxCompletionTime;
+    solution.totalSampleWaitingTime = totalWaiting;
+}
+
 void SolutionEvaluator::evaluateTruckRoute(Route& route, int truckId) {
-    if (route.isEmpty()) {
-        route.completionTime = 0;
-        route.totalWaitingTime = 0;
+    evaluateTruckSequence(route.customers.data(), route.size(),
+                          route.completionTime, route.totalWaitingTime);
+}
+
+bool SolutionEvaluator::evaluateDroneRoute(Route& route, int droneId) {
+    return evaluateDroneSequence(route.customers.data(), route.size(),
+                                 route.completionTime, route.totalWaitingTime);
+}
+
+void SolutionEvaluator::evaluateTruckSequence(const int* customers, int count,
+                                              double& completionTime,
+                                              double& waitingTime) {
+    if (count == 0) {
+        completionTime = 0;
+        waitingTime = 0;
         return;
     }
     
@@ -54,7 +88,8 @@ void SolutionEvaluator::evaluateTruckRoute(Route& route, int truckId) {
     double totalWaiting = 0;
     int prevNode = 0; // Start from depot
     
-    for (int custId : route.customers) {
+    for (int i = 0; i < count; i++) {
+        int custId = customers[i];
         double distance = instance.getDistance(prevNode, custId);
         double travelTime = calculateTruckTravelTime(currentTime, distance);
         currentTime += travelTime;
@@ -70,14 +105,15 @@ void SolutionEvaluator::evaluateTruckRoute(Route& route, int truckId) {
     double travelTime = calculateTruckTravelTime(currentTime, distance);
     currentTime += travelTime;
     
-    route.completionTime = currentTime;
+    completionTime = currentTime;
     
     // Calculate waiting time
     double returnTime = currentTime;    // Lưu thời gian quay về depot
     currentTime = 0;
     prevNode = 0;
     
-    for (int custId : route.customers) {
+    for (int i = 0; i < count; i++) {
+        int custId = customers[i];
         double distance = instance.getDistance(prevNode, custId);
         double travelTime = calculateTruckTravelTime(currentTime, distance);
         currentTime += travelTime;
@@ -91,34 +127,36 @@ void SolutionEvaluator::evaluateTruckRoute(Route& route, int truckId) {
         prevNode = custId;
     }
     
-    route.totalWaitingTime = totalWaiting;
+    waitingTime = totalWaiting;
 }
 
-bool SolutionEvaluator::evaluateDroneRoute(Route& route, int droneId) {
-    if (route.isEmpty()) {
-        route.completionTime = 0;
-        route.totalWaitingTime = 0;
+bool SolutionEvaluator::evaluateDroneSequence(const int* customers, int count,
+                                              double& completionTime,
+                                              double& waitingTime) {
+    if (count == 0) {
+        completionTime = 0;
+        waitingTime = 0;
         return true;
     }
     
     double totalLoad = 0;
-    for (int custId : route.customers) {
-        totalLoad += instance.customers[custId - 1].demand;
+    for (int i = 0; i < count; i++) {
+        totalLoad += instance.customers[customers[i] - 1].demand;
     }
     if (totalLoad > instance.droneParams.maxCapacity) {
         return false;
     }
 
-    if (calculateDroneEnergy(route) > instance.droneParams.maxEnergy) {
+    if (calculateDroneEnergy(customers, count) > instance.droneParams.maxEnergy) {
         return false;
     }
 
     double currentTime = 0;
     int prevNode = 0;
     
-    for (int custId : route.customers) {
-        double distance = instance.getDistance(prevNode, custId);
-        double travelTime = distance / instance.droneParams.cruiseSpeed;
+    for (int i = 0; i < count; i++) {
+        int custId = customers[i];
+        double travelTime = instance.getDroneFlightTime(prevNode, custId);
         currentTime += travelTime;
         
         double serviceTime = instance.customers[custId - 1].serviceTimeDrone;
@@ -127,10 +165,9 @@ bool SolutionEvaluator::evaluateDroneRoute(Route& route, int droneId) {
         prevNode = custId;
     }
     
-    double distance = instance.getDistance(prevNode, 0);
-    currentTime += distance / instance.droneParams.cruiseSpeed;
+    currentTime += instance.getDroneFlightTime(prevNode, 0);
     
-    route.completionTime = currentTime;
+    completionTime = currentTime;
     
     // Calculate waiting time
     double returnTime = currentTime;
@@ -138,9 +175,9 @@ bool SolutionEvaluator::evaluateDroneRoute(Route& route, int droneId) {
     prevNode = 0;
     
     double totalWaiting = 0;
-    for (int custId : route.customers) {
-        double distance = instance.getDistance(prevNode, custId);
-        double travelTime = distance / instance.droneParams.cruiseSpeed;
+    for (int i = 0; i < count; i++) {
+        int custId = customers[i];
+        double travelTime = instance.getDroneFlightTime(prevNode, custId);
         currentTime += travelTime;
         
         double collectTime = currentTime;
@@ -151,66 +188,39 @@ bool SolutionEvaluator::evaluateDroneRoute(Route& route, int droneId) {
         prevNode = custId;
     }
     
-    route.totalWaitingTime = totalWaiting;
+    waitingTime = totalWaiting;
     return true;
 }
 
 // TÍNH THỜI GIAN DI CHUYỂN CÓ PHỤ THUỘC VÀO THỜI ĐIỂM
+// Tra bảng quãng đường tích lũy đã compile: O(log k), không lặp qua intervals
 double SolutionEvaluator::calculateTruckTravelTime(double startTime, double distance) {
-    double time = 0;
-    double remainingDist = distance;
-    double currentTime = startTime;
-    
-    while (remainingDist > 1e-6) {  // Khi còn quãng đường
-        double sigma = getSpeedFactor(currentTime);
-        double speed = instance.truckParams.maxSpeed * sigma;
-        
-        double intervalEnd = INF;
-        for (const auto& interval : instance.truckParams.timeIntervals) {
-            if (currentTime >= interval.startTime && currentTime < interval.endTime) {
-                intervalEnd = interval.endTime;
-                break;
-            }
-        }
-        
-        // Tính quãng đường có thể đi trong interval này
-        double timeToIntervalEnd = intervalEnd - currentTime;
-        double distInInterval = speed * timeToIntervalEnd;
-        
-        // Nếu quãng đường còn lại có thể đi hết trong interval → xong
-        if (distInInterval >= remainingDist) {
-            time += remainingDist / speed;
-            break;
-        } else {
-            // Nếu chưa hết → di chuyển hết interval này, chuyển sang interval tiếp
-            time += timeToIntervalEnd;
-            remainingDist -= distInInterval;
-            currentTime = intervalEnd;
-        }
-    }
-    
-    return time;
+    return instance.truckParams.speedProfile.travelTime(startTime, distance);
 }
 
 double SolutionEvaluator::calculateDroneEnergy(const Route& route) {
+    return calculateDroneEnergy(route.customers.data(), route.size());
+}
+
+double SolutionEvaluator::calculateDroneEnergy(const int* customers, int count) {
     
     // TÍNH NĂNG LƯỢNG TIÊU THỤ CỦA DRONE
     // Energy = (β * Load + γ) * flightTime
 
-    if (route.isEmpty()) return 0;
+    if (count == 0) return 0;
     
     double totalEnergy = 0;
     double currentLoad = 0;
     
-    for (int custId : route.customers) {
-        currentLoad += instance.customers[custId - 1].demand;
+    for (int i = 0; i < count; i++) {
+        currentLoad += instance.customers[customers[i] - 1].demand;
     }
     
     int prevNode = 0;
     
-    for (int custId : route.customers) {
-        double distance = instance.getDistance(prevNode, custId);
-        double travelTime = distance / instance.droneParams.cruiseSpeed;
+    for (int i = 0; i < count; i++) {
+        int custId = customers[i];
+        double travelTime = instance.getDroneFlightTime(prevNode, custId);
         
         double power = instance.droneParams.beta * currentLoad + instance.droneParams.gamma;
         double energy = power * travelTime;
@@ -222,8 +232,7 @@ double SolutionEvaluator::calculateDroneEnergy(const Route& route) {
     }
     
     // Quay về depot (không có tải)
-    double distance = instance.getDistance(prevNode, 0);
-    double travelTime = distance / instance.droneParams.cruiseSpeed;
+    double travelTime = instance.getDroneFlightTime(prevNode, 0);
     double power = instance.droneParams.beta * currentLoad + instance.droneParams.gamma;
     totalEnergy += power * travelTime;
     
@@ -232,75 +241,91 @@ double SolutionEvaluator::calculateDroneEnergy(const Route& route) {
 
 // TÌM HỆ SỐ TỐCĐỘ TẠI THỜI ĐIỂM time
 double SolutionEvaluator::getSpeedFactor(double time) const {
-    for (const auto& interval : instance.truckParams.timeIntervals) {
-        if (time >= interval.startTime && time < interval.endTime) {
-            return interval.sigma;
-        }
-    }
-    // Nếu không tìm thấy (vượt quá cuối ngày) → lấy σ của interval cuối cùng
-    if (!instance.truckParams.timeIntervals.empty()) {
-        return instance.truckParams.timeIntervals.back().sigma;
-    }
-    return 1.0;
+    const auto& truck = instance.truckParams;
+    return truck.speedProfile.speedAt(time) / truck.maxSpeed;
 }
 
 
 // === ParetoRanking Class ===
 
+// Với 2 mục tiêu: duyệt solutions theo (CT, WT) tăng dần. Mọi solution đã
+// duyệt có CT <= CT hiện tại, nên chỉ cần so WT với phần tử cuối của mỗi front
+// (phần tử có WT nhỏ nhất front đó). "Bị front k trội" đơn điệu theo k, nên
+// front của mỗi solution tìm bằng binary search → O(n log n).
 void ParetoRanking::nonDominatedSorting(vector<Solution*>& solutions) {
     int n = solutions.size();
-    vector<int> dominationCount(n, 0);  // Đếm số solution dominate solution i
-    vector<vector<int>> dominatedSolutions(n);  // Danh sách solutions bị i dominate
-    vector<vector<int>> fronts; // Lưu các fronts
-    
-    vector<int> currentFront;
-    
-    for (int i = 0; i < n; i++) {
-        for (int j = i + 1; j < n; j++) {
-            if (solutions[i]->dominates(*solutions[j])) {   // i dominate j
-                dominatedSolutions[i].push_back(j);
-                dominationCount[j]++;
-            } else if (solutions[j]->dominates(*solutions[i])) {    // j dominate i
-                dominatedSolutions[j].push_back(i);
-                dominationCount[i]++;
-            }
+    if (n == 0) return;
+    
+    // Chép mục tiêu ra bảng SoA để sort / sweep / crowding đọc bộ nhớ liên tục
+    ObjectiveStore objectives;
+    objectives.reserve(n);
+    for (const Solution* sol : solutions) {
+        objectives.add(sol->systemCompletionTime, sol->totalSampleWaitingTime);
+    }
+    const double* cts = objectives.completionData();
+    const double* wts = objectives.waitingData();
+    
+    vector<int> order(n);
+    for (int i = 0; i < n; i++) order[i] = i;
+    sort(order.begin(), order.end(), [cts, wts](int a, int b) {
+        if (cts[a] != cts[b]) return cts[a] < cts[b];
+        return wts[a] < wts[b];
+    });
+    
+    vector<int> frontLast;      // phần tử cuối cùng của mỗi front
+    vector<int> frontOf(n);
+    
+    for (int idx : order) {
+        // Front đầu tiên không có phần tử nào trội idx
+        int lo = 0, hi = frontLast.size();
+        while (lo < hi) {
+            int mid = (lo + hi) / 2;
+            int last = frontLast[mid];
+            bool dominated = wts[last] < wts[idx] ||
+                (wts[last] == wts[idx] && cts[last] < cts[idx]);
+            if (dominated) lo = mid + 1;
+            else hi = mid;
         }
         
-        // TÌM FRONT 1
-        if (dominationCount[i] == 0) {  
-            currentFront.push_back(i);
-            solutions[i]->paretoRank = 1;
-        }
+        if (lo == (int)frontLast.size()) frontLast.push_back(idx);
+        else frontLast[lo] = idx;
+        frontOf[idx] = lo;
+        solutions[idx]->paretoRank = lo + 1;
     }
     
-    fronts.push_back(currentFront);
-    
-    //  TÌM FRONT 2, 3, ...
-    int rank = 1;
-    while (!currentFront.empty()) {
-        vector<int> nextFront;
-        for (int i : currentFront) {
-            for (int j : dominatedSolutions[i]) {
-                dominationCount[j]--;
-                if (dominationCount[j] == 0) {  //  Nếu j không còn ai dominate
-                    nextFront.push_back(j);
-                    solutions[j]->paretoRank = rank + 1;
-                }
-            }
-        }
-        if (!nextFront.empty()) {
-            fronts.push_back(nextFront);
-        }
-        currentFront = nextFront;
-        rank++;
-    }
+    // Gom theo front (counting sort ổn định): mỗi front vẫn theo CT tăng dần,
+    // cũng chính là WT giảm dần → crowding không cần sort lại
+    int numFronts = frontLast.size();
+    vector<int> frontStart(numFronts + 1, 0);
+    for (int i = 0; i < n; i++) frontStart[frontOf[i] + 1]++;
+    for (int f = 0; f < numFronts; f++) frontStart[f + 1] += frontStart[f];
     
-    for (auto& frontIndexes : fronts) {
-        vector<Solution*> frontSols;
-        for (int idx : frontIndexes) {
-            frontSols.push_back(solutions[idx]);
+    vector<int> grouped(n);
+    vector<int> fill(frontStart.begin(), frontStart.end() - 1);
+    for (int idx : order) grouped[fill[frontOf[idx]]++] = idx;
+    
+    for (int f = 0; f < numFronts; f++) {
+        const int* front = grouped.data() + frontStart[f];
+        int size = frontStart[f + 1] - frontStart[f];
+        
+        if (size <= 2) {
+            for (int i = 0; i < size; i++) solutions[front[i]]->crowdingDistance = INF;
+            continue;
+        }
+        
+        int first = front[0], last = front[size - 1];
+        double ctRange = cts[last] - cts[first];
+        double wtRange = wts[first] - wts[last];
+        
+        solutions[first]->crowdingDistance = INF;
+        solutions[last]->crowdingDistance = INF;
+        for (int i = 1; i < size - 1; i++) {
+            int prev = front[i - 1], next = front[i + 1];
+            double distance = 0;
+            if (ctRange >= 1e-6) distance += (cts[next] - cts[prev]) / ctRange;
+            if (wtRange >= 1e-6) distance += (wts[prev] - wts[next]) / wtRange;
+            solutions[front[i]]->crowdingDistance = distance;
         }
-        calculateCrowdingDistance(frontSols);
     }
 }
 
@@ -346,25 +371,22 @@ void ParetoRanking::calculateCrowdingDistance(vector<Solution*>& front) {
 // === SolutionHasher Implementation ===
 
 SolutionHasher::SolutionHasher(int maxCustomers, int maxTrucks, int maxDrones) {
-    initializeZobristTable(maxCustomers, maxTrucks, maxDrones);
+    // Seed cố định để reproducible; kích thước chỉ để tách các instance khác nhau
+    seed = mix(42 ^ ((uint64_t)maxCustomers << 40) ^
+               ((uint64_t)maxTrucks << 20) ^ (uint64_t)maxDrones);
 }
 
-void SolutionHasher::initializeZobristTable(int maxCustomers, int maxTrucks, int maxDrones) {
-    std::mt19937_64 rng(42);  // Seed cố định để reproducible
-    std::uniform_int_distribution<uint64_t> dist;
-    
-    int maxRoutes = maxTrucks + maxDrones * 10;  // Drone có nhiều trips
-    int maxPositions = maxCustomers;
-    
-    // Tạo số ngẫu nhiên cho mỗi (customer, route, position)
-    for (int customer = 1; customer <= maxCustomers; customer++) {
-        for (int route = 0; route < maxRoutes; route++) {
-            for (int position = 0; position < maxPositions; position++) {
-                auto key = std::make_tuple(customer, route, position);
-                zobristTable[key] = dist(rng);
-            }
-        }
+uint64_t SolutionHasher::routeHash(uint64_t routeKey, const int* customers, int count) const {
+    if (count == 0) return 0;
+    
+    uint64_t hash = 0;
+    int prev = 0;  // depot
+    for (int i = 0; i < count; i++) {
+        hash ^= edgeKey(routeKey, prev, customers[i]);
+        prev = customers[i];
     }
+    hash ^= edgeKey(routeKey, prev, 0);
+    return hash;
 }
 
 uint64_t SolutionHasher::computeHash(const Solution& solution) const {
@@ -373,41 +395,44 @@ uint64_t SolutionHasher::computeHash(const Solution& solution) const {
     // Hash truck routes
     for (size_t truckId = 0; truckId < solution.truckRoutes.size(); truckId++) {
         const Route& route = solution.truckRoutes[truckId];
-        
-        for (size_t pos = 0; pos < route.customers.size(); pos++) {
-            int customer = route.customers[pos];
-            int routeId = truckId;  // Route ID for trucks
-            
-            auto key = std::make_tuple(customer, routeId, (int)pos);
-            
-            // XOR với Zobrist value
-            if (zobristTable.find(key) != zobristTable.end()) {
-                hash ^= zobristTable.at(key);
-            }
-        }
+        hash ^= routeHash(truckRouteKey(truckId), route.customers.data(), route.size());
     }
     
     // Hash drone routes
     for (size_t droneId = 0; droneId < solution.droneRoutes.size(); droneId++) {
         const auto& trips = solution.droneRoutes[droneId];
-        
         for (size_t tripId = 0; tripId < trips.size(); tripId++) {
-            const Route& trip = trips[tripId];
-            
-            // Route ID cho drone: offset sau truck routes
-            int routeId = solution.truckRoutes.size() + droneId * 10 + tripId;
-            
-            for (size_t pos = 0; pos < trip.customers.size(); pos++) {
-                int customer = trip.customers[pos];
-                
-                auto key = std::make_tuple(customer, routeId, (int)pos);
-                
-                if (zobristTable.find(key) != zobristTable.end()) {
-                    hash ^= zobristTable.at(key);
-                }
-            }
+            hash ^= routeHash(droneRouteKey(droneId, tripId),
+                              trips[tripId].customers.data(), trips[tripId].size());
         }
     }
     
     return hash;
 }
+
+uint64_t SolutionHasher::computeHash(const FlatSolution& solution) const {
+    uint64_t hash = 0;
+    for (const auto& d : solution.routes) {
+        uint64_t key = (d.vehicleType == 0) ? truckRouteKey(d.vehicleId)
+                                            : droneRouteKey(d.vehicleId, d.tripId);
+        hash ^= routeHash(key, solution.customers.data() + d.offset, d.length);
+    }
+    return hash;
+}
+
+uint64_t SolutionHasher::swapDelta(uint64_t routeKeyA, int prevA, int a, int nextA,
+                                   uint64_t routeKeyB, int prevB, int b, int nextB) const {
+    if (routeKeyA == routeKeyB && (nextA == b || nextB == a)) {
+        // a, b kề nhau: p → x → y → n  thành  p → y → x → n
+        int x = (nextA == b) ? a : b;
+        int y = (nextA == b) ? b : a;
+        int p = (nextA == b) ? prevA : prevB;
+        int n = (nextA == b) ? nextB : nextA;
+        return edgeKey(routeKeyA, p, x) ^ edgeKey(routeKeyA, x, y) ^ edgeKey(routeKeyA, y, n) ^
+               edgeKey(routeKeyA, p, y) ^ edgeKey(routeKeyA, y, x) ^ edgeKey(routeKeyA, x, n);
+    }
+    
+    // Xóa a, chèn b vào chỗ a; xóa b, chèn a vào chỗ b (cạnh prev→next tự triệt tiêu)
+    return linkDelta(routeKeyA, prevA, a, nextA) ^ linkDelta(routeKeyA, prevA, b, nextA) ^
+           linkDelta(routeKeyB, prevB, b, nextB) ^ linkDelta(routeKeyB, prevB, a, nextB);
+}
@@ -0,0 +1,60 @@
+#include "ThreadPool.h"
+
+ThreadPool::ThreadPool(int numThreads) {
+    for (int i = 0; i < numThreads; i++) {
+        threads.emplace_back(&ThreadPool::workerLoop, this, i);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    startCv.notify_all();
+    for (auto& t : threads) {
+        t.join();
+    }
+}
+
+void ThreadPool::run(int numTasks, const std::function<void(int, int)>& fn) {
+    if (numTasks <= 0) return;
+    
+    std::unique_lock<std::mutex> lock(mutex);
+    job = &fn;
+    jobTasks = numTasks;
+    nextTask = 0;
+    busyWorkers = threads.size();
+    generation++;
+    startCv.notify_all();
+    
+    doneCv.wait(lock, [this] { return busyWorkers == 0; });
+    job = nullptr;
+}
+
+void ThreadPool::workerLoop(int workerId) {
+    unsigned long seenGeneration = 0;
+    
+    while (true) {
+        const std::function<void(int, int)>* currentJob;
+        int numTasks;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            startCv.wait(lock, [&] { return stopping || generation != seenGeneration; });
+            if (stopping) return;
+            seenGeneration = generation;
+            currentJob = job;
+            numTasks = jobTasks;
+        }
+        
+        // Lấy task động cho đến khi hết
+        for (int task = nextTask++; task < numTasks; task = nextTask++) {
+            (*currentJob)(task, workerId);
+        }
+        
+        std::lock_guard<std::mutex> lock(mutex);
+        if (--busyWorkers == 0) {
+            doneCv.notify_one();
+        }
+    }
+}
@@ -0,0 +1,14 @@
+#ifndef ALLOCCOUNTER_H
+#define ALLOCCOUNTER_H
+
+#include <cstdint>
+
+// Đếm số lần cấp phát heap toàn cục (operator new) để phát hiện cấp phát
+// trong vòng lặp chính. Chỉ hoạt động khi build với -DICAHGS_COUNT_ALLOCS;
+// ngược lại enabled() = false và count() luôn = 0.
+namespace AllocCounter {
+    bool enabled();
+    uint64_t count();
+}
+
+#endif // ALLOCCOUNTER_H
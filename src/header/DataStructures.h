@@ -51,12 +51,64 @@ struct DroneParams {
                     maxFlightTime(0) {}
 };
 
+// Piecewise-linear distance-vs-time table compiled from the speed profile.
+// D(t) = distance a truck covers from time 0 to t. Since speed > 0, D is
+// strictly increasing, so travel queries reduce to D and its inverse:
+//   arrival(dep, dist) = D^-1(D(dep) + dist)     O(log k)
+struct SpeedProfile {
+    vector<double> breakTimes;  // start of segment j
+    vector<double> cumDist;     // D(breakTimes[j])
+    vector<double> speeds;      // m/s inside segment j (last one is open-ended)
+    
+    bool isCompiled() const { return !breakTimes.empty(); }
+    
+    void compile(const vector<TimeInterval>& intervals, double maxSpeed);
+    
+    // Speed (m/s) at time t
+    double speedAt(double t) const { return speeds[segmentAtTime(t)]; }
+    
+    // D(t): cumulative distance travelled from time 0 to t
+    double distanceAt(double t) const {
+        int j = segmentAtTime(t);
+        return cumDist[j] + speeds[j] * (t - breakTimes[j]);
+    }
+    
+    // D^-1(d): time at which cumulative distance d is reached
+    double timeAtDistance(double d) const {
+        int j = segmentAtDistance(d);
+        return breakTimes[j] + (d - cumDist[j]) / speeds[j];
+    }
+    
+    // Arrival time when leaving at departTime and driving distance
+    double arrivalTime(double departTime, double distance) const {
+        return timeAtDistance(distanceAt(departTime) + distance);
+    }
+    
+    double travelTime(double departTime, double distance) const {
+        return arrivalTime(departTime, distance) - departTime;
+    }
+    
+    // Inverse query: latest departure that arrives at arriveTime
+    double departureTime(double arriveTime, double distance) const {
+        double d = distanceAt(arriveTime) - distance;
+        return (d <= 0) ? breakTimes[0] : timeAtDistance(d);
+    }
+    
+private:
+    int segmentAtTime(double t) const;
+    int segmentAtDistance(double d) const;
+};
+
 // Truck parameters
 struct TruckParams {
     double maxSpeed;  // Vmax (m/s)
     vector<TimeInterval> timeIntervals;  // danh sách các khoảng thời gian, tắc đường
+    SpeedProfile speedProfile;           // compiled from timeIntervals
     
     TruckParams() : maxSpeed(0) {}
+    
+    // Must be called after timeIntervals / maxSpeed change
+    void compileSpeedProfile() { speedProfile.compile(timeIntervals, maxSpeed); }
 };
 
 // Instance data
@@ -71,8 +123,32 @@ struct Instance {
     double depotX = 0.0;
     double depotY = 0.0;
     
+    // Precomputed matrices, row-major (n+1)x(n+1), node 0 = depot.
+    // Left empty when n exceeds maxMatrixNodes -> fall back to on-the-fly.
+    int matrixSize = 0;
+    vector<double> distanceMatrix;
+    vector<double> droneTimeMatrix;  // distance / cruiseSpeed
+    vector<double> truckTimeMatrix;  // distance / truck maxSpeed (mô hình tốc độ hằng của decoder)
+    
+    // Granular neighbourhoods: k customers gần nhất của mỗi customer,
+    // flat theo hàng (hàng c bắt đầu tại c * numNeighbors, hàng 0 = depot bỏ trống).
+    // numNeighbors = 0 → local search dùng toàn bộ neighbourhood.
+    int numNeighbors = 0;
+    vector<int> nearestNeighbors;
+    
     int getNumCustomers() const { return customers.size(); }
     
+    // Build distance + drone flight time + truck time matrices once after loading
+    // (cruiseSpeed / maxSpeed must already be set). Returns false if skipped.
+    bool buildDistanceMatrix(int maxMatrixNodes = 4096);
+    bool hasDistanceMatrix() const { return !distanceMatrix.empty(); }
+    
+    // Candidate lists k-nearest từ tọa độ customers (gọi một lần sau khi load)
+    void buildNeighborLists(int k);
+    const int* getNeighbors(int custId) const {
+        return &nearestNeighbors[custId * numNeighbors];
+    }
+    
     // Calculate Euclidean distance
     double getDistance(double x1, double y1, double x2, double y2) const {
         double dx = x2 - x1;
@@ -81,6 +157,33 @@ struct Instance {
     }
     
     double getDistance(int custId1, int custId2) const {
+        if (!distanceMatrix.empty()) {
+            return distanceMatrix[custId1 * matrixSize + custId2];
+        }
+        return computeDistance(custId1, custId2);
+    }
+    
+    // Thời gian truck ở tốc độ hằng maxSpeed (không theo khung giờ)
+    double getTruckTime(int custId1, int custId2) const {
+        if (!truckTimeMatrix.empty()) {
+            return truckTimeMatrix[custId1 * matrixSize + custId2];
+        }
+        return computeDistance(custId1, custId2) / truckParams.maxSpeed;
+    }
+    // Hàng custId của truckTimeMatrix (chỉ dùng khi hasDistanceMatrix())
+    const double* getTruckTimeRow(int custId) const {
+        return &truckTimeMatrix[(size_t)custId * matrixSize];
+    }
+    
+    // Drone flight time between two nodes at cruise speed
+    double getDroneFlightTime(int custId1, int custId2) const {
+        if (!droneTimeMatrix.empty()) {
+            return droneTimeMatrix[custId1 * matrixSize + custId2];
+        }
+        return computeDistance(custId1, custId2) / droneParams.cruiseSpeed;
+    }
+    
+    double computeDistance(int custId1, int custId2) const {
         if (custId1 == 0) { // Depot
             return getDistance(depotX, depotY, 
                              customers[custId2-1].x, customers[custId2-1].y);
@@ -113,6 +216,8 @@ struct Route {
 };
 
 // Solution structure
+struct FlatSolution;
+
 struct Solution {
     vector<Route> truckRoutes;
     vector<vector<Route>> droneRoutes; // Multiple trips per drone
@@ -128,7 +233,7 @@ struct Solution {
     uint64_t solutionHash;
     
     Solution() : systemCompletionTime(INF), totalSampleWaitingTime(INF),
-                 paretoRank(0), crowdingDistance(0) {}
+                 paretoRank(0), crowdingDistance(0), solutionHash(0) {}
     
     // kiểm tra xem có dominate với lời giải khác không
     bool dominates(const Solution& other) const {
@@ -144,6 +249,7 @@ struct Solution {
         }
         return better;
     }
+    bool dominates(const FlatSolution& other) const;
     
     void clear() {
         truckRoutes.clear();
@@ -152,6 +258,144 @@ struct Solution {
         totalSampleWaitingTime = INF;
         paretoRank = 0;
         crowdingDistance = 0;
+        solutionHash = 0;
+    }
+};
+
+// Kho buffer customers của các drone trip bị bỏ đi, để trip mới dùng lại thay
+// vì cấp phát (số trip của mỗi drone thay đổi liên tục khi decode / local search).
+class RouteBufferPool {
+public:
+    // Kho của thread hiện tại (Decoder và LocalSearch cùng thread dùng chung,
+    // nên buffer trả về ở bên này được bên kia lấy lại)
+    static RouteBufferPool& local();
+    
+    // Đổi số trip thành count: trip thừa trả buffer về kho, trip mới lấy từ kho
+    void resizeTrips(vector<Route>& trips, size_t count);
+    // Thêm một trip rỗng vào cuối, trả về trip đó
+    Route& addTrip(vector<Route>& trips);
+    // Copy source vào target, giữ lại buffer của target
+    void assign(Solution& target, const Solution& source);
+    
+private:
+    vector<vector<int>> buffers;
+};
+
+// Một route trong FlatSolution: customers[offset .. offset + length)
+struct RouteDescriptor {
+    int vehicleType;   // 0 = truck, 1 = drone
+    int vehicleId;
+    int tripId;        // -1 cho truck
+    int offset;
+    int length;
+    double completionTime;
+    double totalWaitingTime;
+};
+
+// Route chỉ đọc trỏ vào mảng customers của FlatSolution (thay cho const Route&)
+struct RouteView {
+    const int* customers;
+    int length;
+    double completionTime;
+    double totalWaitingTime;
+    
+    int size() const { return length; }
+    bool isEmpty() const { return length == 0; }
+    int operator[](int i) const { return customers[i]; }
+    const int* begin() const { return customers; }
+    const int* end() const { return customers + length; }
+};
+
+// Dạng phẳng của Solution: mọi customer nằm trong một mảng liên tục, cộng bảng
+// RouteDescriptor (mọi truck theo id, kể cả rỗng, rồi các drone trip theo
+// drone / trip). Chỉ gồm POD nên copy là hai memcpy, không cấp phát theo route.
+// assign() tái sử dụng bộ nhớ sẵn có nên hợp làm snapshot / bản lưu archive.
+struct FlatSolution {
+    vector<int> customers;
+    vector<RouteDescriptor> routes;
+    int numTrucks;
+    int numDrones;
+    
+    double systemCompletionTime;
+    double totalSampleWaitingTime;
+    int paretoRank;
+    double crowdingDistance;
+    uint64_t solutionHash;
+    
+    FlatSolution() : numTrucks(0), numDrones(0), systemCompletionTime(INF),
+                     totalSampleWaitingTime(INF), paretoRank(0),
+                     crowdingDistance(0), solutionHash(0) {}
+    explicit FlatSolution(const Solution& solution) : FlatSolution() { assign(solution); }
+    
+    void assign(const Solution& solution);
+    void expandInto(Solution& solution) const;
+    Solution toSolution() const;
+    
+    bool dominates(const FlatSolution& other) const {
+        return systemCompletionTime <= other.systemCompletionTime &&
+               totalSampleWaitingTime <= other.totalSampleWaitingTime &&
+               (systemCompletionTime < other.systemCompletionTime ||
+                totalSampleWaitingTime < other.totalSampleWaitingTime);
+    }
+    
+    // Truy cập kiểu cũ
+    int numRoutes() const { return routes.size(); }
+    RouteView route(int r) const {
+        const RouteDescriptor& d = routes[r];
+        return {customers.data() + d.offset, d.length, d.completionTime, d.totalWaitingTime};
+    }
+    RouteView truckRoute(int truckId) const { return route(truckId); }
+    // Các trip của drone là đoạn routes[first, last)
+    void droneTripRange(int droneId, int& first, int& last) const;
+    int numTrips(int droneId) const {
+        int first, last;
+        droneTripRange(droneId, first, last);
+        return last - first;
+    }
+    RouteView droneTrip(int droneId, int tripId) const {
+        int first, last;
+        droneTripRange(droneId, first, last);
+        return route(first + tripId);
+    }
+};
+
+inline bool Solution::dominates(const FlatSolution& other) const {
+    return systemCompletionTime <= other.systemCompletionTime &&
+           totalSampleWaitingTime <= other.totalSampleWaitingTime &&
+           (systemCompletionTime < other.systemCompletionTime ||
+            totalSampleWaitingTime < other.totalSampleWaitingTime);
+}
+
+// Vị trí của một customer trong solution
+struct CustomerLocation {
+    int vehicleType;  // 0 = truck, 1 = drone, -1 = chưa được phục vụ
+    int vehicleId;
+    int tripId;       // -1 cho truck
+    int position;     // index trong route / trip
+    
+    CustomerLocation() : vehicleType(-1), vehicleId(-1), tripId(-1), position(-1) {}
+    
+    bool isServed() const { return vehicleType != -1; }
+};
+
+// Index customer id → vị trí, tra O(1). Sau khi sửa một route, gọi
+// reindexRoute cho route đó (O(độ dài route)) thay vì build lại toàn bộ.
+struct CustomerIndex {
+    vector<CustomerLocation> locations;  // index theo customer id (0 = depot, bỏ trống)
+    
+    void build(const Solution& solution, int numCustomers);
+    void reindexRoute(const Solution& solution, int vehicleType, int vehicleId, int tripId = -1);
+    void remove(int custId) { locations[custId] = CustomerLocation(); }
+    
+    const CustomerLocation& operator[](int custId) const { return locations[custId]; }
+    
+    static Route& routeAt(Solution& solution, const CustomerLocation& loc) {
+        return loc.vehicleType == 0 ? solution.truckRoutes[loc.vehicleId]
+                                    : solution.droneRoutes[loc.vehicleId][loc.tripId];
+    }
+    static const Route& routeAt(const Solution& solution, const CustomerLocation& loc) {
+        return loc.vehicleType == 0 ? solution.truckRoutes[loc.vehicleId]
+                                    : solution.droneRoutes[loc.vehicleId][loc.tripId];
     }
 };
 
@@ -168,13 +412,14 @@ struct Individual {
     }
 };
 
-// Empire structure
+// Empire structure: imperialist / colonies là chỉ số vào population pool
+// (ICAHGS::population), đổi chỗ / chuyển colony chỉ là đổi chỉ số
 struct Empire {
-    Individual imperialist;
-    vector<Individual> colonies;
+    int imperialist;
+    vector<int> colonies;
     double power;
     
-    Empire() : power(0) {}
+    Empire() : imperialist(-1), power(0) {}
     
     int getTotalSize() const {
         return 1 + colonies.size();
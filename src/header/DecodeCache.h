@@ -0,0 +1,73 @@
+#ifndef DECODECACHE_H
+#define DECODECACHE_H
+
+#include "DataStructures.h"
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+// Cache kết quả decode theo hoán vị. Khi empire hội tụ và mutation rate thấp,
+// cùng một hoán vị offspring xuất hiện lặp lại nhiều lần; cache cho biết
+// ngay hash sau decode (để kiểm tra trùng) và lời giải sau local search, nên
+// không phải decode / local search lại.
+//
+// Dung lượng cố định (số entry), thay thế theo CLOCK. Khóa là rolling hash
+// của hoán vị, entry lưu cả hoán vị để so khớp chính xác (không nhầm khi
+// trùng hash). Mỗi thread dùng cache riêng.
+//
+// configure() cấp sẵn buffer của mọi entry (hoán vị n gene, FlatSolution n
+// customer và numRoutes route), nên insert không cấp phát kể cả khi cache chưa
+// đầy. ICAHGS dùng numRoutes = số truck + n (mỗi drone trip có ít nhất một
+// customer), khoảng 10 KB mỗi entry với n = 200.
+class DecodeCache {
+public:
+    static const size_t DEFAULT_CAPACITY = 2048;
+
+    struct Entry {
+        uint64_t key;
+        std::vector<int> permutation;
+        uint64_t decodedHash;   // solutionHash ngay sau decode
+        bool improved;          // result đã qua local search chưa
+        FlatSolution result;    // chỉ có nghĩa khi improved
+        bool referenced;        // bit CLOCK
+    };
+
+    explicit DecodeCache(size_t capacity = DEFAULT_CAPACITY, int numCustomers = 0,
+                         int numRoutes = 0);
+
+    // Đổi dung lượng, cấp sẵn buffer entry và xóa hết entry; 0 → tắt cache
+    void configure(size_t capacity, int numCustomers, int numRoutes);
+    void clear();
+    bool enabled() const { return capacity > 0; }
+
+    // nullptr nếu chưa gặp hoán vị này (đếm vào misses)
+    const Entry* find(const std::vector<int>& permutation);
+    // Ghi / cập nhật entry của hoán vị; improved == nullptr → chỉ lưu hash decode
+    void insert(const std::vector<int>& permutation, uint64_t decodedHash,
+                const Solution* improved);
+
+    size_t size() const { return numEntries; }
+    uint64_t hits() const { return hitCount; }
+    uint64_t misses() const { return missCount; }
+
+    static uint64_t hashPermutation(const std::vector<int>& permutation);
+
+private:
+    size_t capacity;
+    int numCustomers;         // kích thước buffer cấp sẵn cho mỗi entry
+    int numRoutes;
+    std::vector<Entry> entries;  // luôn có capacity phần tử, dùng numEntries đầu
+    size_t numEntries;
+    std::vector<int> index;   // open addressing: vị trí entry hoặc -1
+    size_t mask;
+    size_t hand;              // kim CLOCK
+    uint64_t hitCount;
+    uint64_t missCount;
+
+    size_t home(uint64_t key) const { return key & mask; }
+    int lookup(uint64_t key, const std::vector<int>& permutation, size_t& slot) const;
+    size_t evict();
+    void removeFromIndex(size_t slot);
+};
+
+#endif // DECODECACHE_H
@@ -3,18 +3,45 @@
 
 #include "DataStructures.h"
 #include "Solution.h"
+#include "InsertionKernel.h"
+
+struct DecoderParams {
+    enum Mode {
+        INSERTION,  // chèn rẻ nhất từng customer (mặc định)
+        SPLIT       // cắt hoán vị thành route bằng DP đường đi ngắn nhất
+    };
+    Mode mode;
+    int splitMaxRouteLength;  // số customer tối đa của một truck route khi SPLIT,
+                              // 0 → 2·⌈n / numTrucks⌉
+    int checkpointInterval;   // INSERTION: decodeReference lưu trạng thái mỗi ngần ấy
+                              // customer để decode sau chỉ chạy lại phần đuôi, 0 → tắt
+    int regretK;              // INSERTION: >= 2 → mỗi bước chèn customer có regret-k lớn
+                              // nhất (hoán vị chỉ để phá hòa), 0 → theo thứ tự hoán vị
+    
+    DecoderParams() : mode(INSERTION), splitMaxRouteLength(0), checkpointInterval(0),
+                      regretK(0) {}
+};
 
 class Decoder {
 public:
-    Decoder(const Instance& inst) : instance(inst), evaluator(inst) {}
+    Decoder(const Instance& inst, const DecoderParams& params = DecoderParams());
     
     Solution decode(const std::vector<int>& permutation);
+    // Decode vào solution có sẵn, tái sử dụng bộ nhớ route của nó. Nếu hoán vị
+    // chung prefix với hoán vị tham chiếu thì chỉ decode lại phần đuôi.
+    void decode(const std::vector<int>& permutation, Solution& solution);
+    // Decode đầy đủ và lưu checkpoint; hoán vị này thành tham chiếu cho các
+    // lần decode sau (vd. imperialist trước khi decode offspring của nó).
+    // Không làm gì nếu nó đã là tham chiếu hoặc checkpoint bị tắt.
+    void setReference(const std::vector<int>& permutation);
     //  NEW: Incremental decoder
     Solution decodeIncremental(const std::vector<int>& permutation);
     
 private:
     const Instance& instance;
+    DecoderParams params;
     SolutionEvaluator evaluator;
+    SolutionHasher hasher;  // cập nhật solutionHash O(1) mỗi lần chèn
     
     struct InsertionMove {
         int routeType;  // 0 = truck, 1 = drone
@@ -26,6 +53,19 @@ private:
                          cost(INF) {}
     };
     
+    void decodeInsertion(const std::vector<int>& permutation, Solution& solution,
+                         bool record);
+    void resetSolution(Solution& solution);
+    // Split: trả về false nếu không có cách cắt hợp lệ
+    bool decodeSplit(const std::vector<int>& permutation, Solution& solution);
+    
+    // Regret-k: không có prefix chung giữa các hoán vị nên không dùng checkpoint
+    void decodeRegret(const std::vector<int>& permutation, Solution& solution);
+    
+    // Chèn một customer vào vị trí tốt nhất, chỉ cập nhật route bị chạm
+    void insertCustomer(int custId, Solution& solution);
+    void applyInsertion(int custId, const InsertionMove& move, Solution& solution);
+    
     InsertionMove findBestTruckInsertion(int custId, Solution& solution);
     InsertionMove findBestDroneInsertion(int custId, Solution& solution);
     
@@ -34,20 +74,87 @@ private:
     
     // NEW: Incremental evaluation functions
     InsertionMove findBestTruckInsertionIncremental(int custId, Solution& solution);
-    InsertionMove findBestDroneInsertionIncremental(int custId, Solution& solution);
+    InsertionMove findBestDroneInsertionIncremental(int custId);
+    // Vị trí tốt nhất trong một truck route / một drone (mọi trip + trip mới)
+    InsertionMove findBestTruckPosition(int custId, int truckId, Solution& solution);
+    InsertionMove findBestDroneTrip(int custId, int droneId);
+    
+    // Cache forward data của mỗi truck route (mô hình tốc độ hằng maxSpeed):
+    // arrival[i] = thời điểm xong phục vụ customer i.
+    // nodes / prevToNext: dữ liệu SoA cho InsertionKernel (xem TruckRouteBatch).
+    struct TruckRouteCache {
+        std::vector<double> arrival;
+        std::vector<int> nodes;
+        std::vector<double> prevToNext;
+    };
+    std::vector<TruckRouteCache> truckCaches;
+    
+    // Trạng thái của mỗi drone trip: khi decode trip chỉ được nối thêm ở cuối
+    // nên cập nhật O(1) mỗi lần nối, chi phí nối thêm một customer cũng O(1).
+    // Các tổng tích lũy theo đúng thứ tự như khi duyệt lại trip → kết quả
+    // giống hệt từng bit.
+    struct DroneTripCache {
+        int last;               // customer cuối
+        double load;
+        double time;            // thời điểm xong phục vụ customer cuối
+        double waiting;         // tổng time sau mỗi customer
+        double completionTime;  // time + bay về depot
+        double energy;
+        bool closed;            // chắc chắn không nhận thêm được customer nào
+    };
+    std::vector<std::vector<DroneTripCache>> droneCaches;  // [drone][trip]
     
-    // Helper: Tính delta cost cho truck insertion
+    // Bảng theo customer, dựng một lần mỗi instance: chi phí của trip chỉ gồm
+    // customer đó (INF nếu vượt năng lượng) và customer có thể bay được không.
+    // Quãng bay thỏa bất đẳng thức tam giác nên trip chứa c không ngắn hơn
+    // depot → c → depot, không nhẹ hơn demand của c.
+    std::vector<double> singleTripCost;
+    std::vector<char> canFly;
+    double minDroneDemand;
+    
+    void buildDroneTables();
+    void resetRouteCaches();
+    void refreshTruckCache(const Route& route, int truckId);
+    void appendDroneCache(int droneId, int tripId, int custId);
+    
+    // Trạng thái sau khi xử lý position phần tử đầu của checkpointPermutation
+    // (hoán vị tham chiếu gần nhất)
+    struct DecodeCheckpoint {
+        int position;
+        uint64_t solutionHash;
+        std::vector<int> customers;     // mọi route nối liền
+        std::vector<int> routeLengths;  // độ dài truck, rồi mỗi drone: số trip + độ dài
+    };
+    std::vector<int> checkpointPermutation;
+    Solution referenceSolution;  // đích decode của setReference
+    std::vector<DecodeCheckpoint> checkpoints;  // theo position tăng dần
+    size_t numCheckpoints = 0;                  // số checkpoint của tham chiếu hiện tại
+    
+    // Cache cho regret-k: vị trí tốt nhất của mỗi customer chưa chèn trong mỗi
+    // route (truck 0..K-1, rồi drone K..K+D-1). Chi phí chèn vào một route chỉ
+    // phụ thuộc route đó, nên chèn xong chỉ route vừa đổi bị đánh version mới;
+    // mỗi bước mỗi customer còn lại chỉ tính lại đúng route ấy.
+    struct CachedMove {
+        InsertionMove move;
+        uint64_t version;  // routeVersion lúc tính, lệch → phải tính lại
+    };
+    std::vector<CachedMove> insertionCache;  // [custId * số route + route]
+    std::vector<uint64_t> routeVersion;
+    uint64_t nextVersion = 0;  // tăng mãi qua các lần decode, nên không cần xóa cache
+    
+    const InsertionMove& cachedMove(int custId, int routeIdx, Solution& solution);
+    
+    int restoreCheckpoint(const std::vector<int>& permutation, Solution& solution);
+    void saveCheckpoint(int position, const Solution& solution);
+    
+    // Helper: Tính delta cost cho truck insertion (O(1) nhờ truckCaches)
     double computeTruckInsertionDelta(const Solution& current, 
                                       int custId, 
                                       int truckId, 
                                       int position);
     
-    // Helper: Tính delta cost cho drone insertion
-    double computeDroneInsertionDelta(const Solution& current, 
-                                      int custId, 
-                                      int droneId, 
-                                      int tripId,
-                                      bool newTrip);
+    // Helper: Tính delta cost khi nối custId vào cuối trip (O(1) nhờ droneCaches)
+    double computeDroneInsertionDelta(const DroneTripCache& trip, int custId);
     
     // Helper: Evaluate single route (not entire solution)
     double evaluateSingleTruckRoute(const Route& route, int truckId);
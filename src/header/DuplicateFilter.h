@@ -0,0 +1,57 @@
+#ifndef DUPLICATEFILTER_H
+#define DUPLICATEFILTER_H
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+// Tập hash lời giải đã gặp với bộ nhớ cố định (thay cho unordered_set lớn dần).
+// Hai thế hệ, mỗi thế hệ là một bảng open addressing dò tuyến tính (các ô
+// liền nhau trong cùng cache line). Thêm vào thế hệ hiện tại; khi bảng này
+// đầy tới MAX_LOAD thì thế hệ cũ bị bỏ, thế hệ hiện tại thành thế hệ cũ. Tra
+// cứu xem cả hai bảng → O(1), và hash gặp lại ở thế hệ cũ được chuyển lên
+// thế hệ hiện tại nên lời giải hay gặp không bị quên.
+//
+// Cái giá: hash chỉ gặp một lần từ trước hai thế hệ có thể bị coi là mới.
+class DuplicateFilter {
+public:
+    static const size_t DEFAULT_MEMORY_BYTES = 16u << 20;  // 16 MB
+
+    explicit DuplicateFilter(size_t memoryBytes = DEFAULT_MEMORY_BYTES);
+
+    // Đặt lại ngân sách bộ nhớ (cho cả hai thế hệ) và xóa mọi hash
+    void configure(size_t memoryBytes);
+    void clear();
+
+    bool contains(uint64_t hash) const;
+    // Thêm hash, trả về false nếu đã có (giống unordered_set::insert().second)
+    bool insert(uint64_t hash);
+
+    // Xấp xỉ: hash vừa được chuyển lên thế hệ mới bị đếm hai lần
+    size_t size() const { return currentCount + previousCount; }
+    size_t capacity() const { return maxPerGeneration; }  // số hash mỗi thế hệ
+    size_t memoryBytes() const { return 2 * tableSize * sizeof(uint64_t); }
+    uint64_t generations() const { return generation; }
+
+private:
+    static constexpr uint64_t EMPTY = 0;
+    static constexpr double MAX_LOAD = 0.5;
+
+    std::vector<uint64_t> current;
+    std::vector<uint64_t> previous;
+    size_t tableSize;   // lũy thừa của 2
+    size_t mask;
+    size_t maxPerGeneration;
+    size_t currentCount;
+    size_t previousCount;
+    uint64_t generation;
+
+    // 0 dành cho ô trống
+    static uint64_t key(uint64_t hash) { return hash == EMPTY ? 1 : hash; }
+    size_t home(uint64_t k) const;
+    static bool find(const std::vector<uint64_t>& table, size_t start, size_t mask, uint64_t k);
+    void insertNew(uint64_t k);
+    void advanceGeneration();
+};
+
+#endif // DUPLICATEFILTER_H
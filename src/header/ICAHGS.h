@@ -5,48 +5,141 @@
 #include "Solution.h"
 #include "Decoder.h"
 #include "LocalSearch.h"
+#include "ThreadPool.h"
+#include "MigrationChannel.h"
+#include "ParetoArchive.h"
+#include "DuplicateFilter.h"
+#include "DecodeCache.h"
 #include <vector>
+#include <memory>
+#include <map>
 #include <random>
-#include <unordered_set>  // ← THÊM DÒNG NÀY (cho unordered_set)
 #include <cstdint>
 
+// Tùy chọn chạy thuật toán (đọc từ command line trong main)
+struct ICAHGSOptions {
+    LocalSearchParams localSearch;
+    DecoderParams decoder;
+    int numThreads;         // > 1 → đánh giá offspring song song
+    int numIslands;         // > 1 → island model, mỗi island một nhóm empire
+    int migrationInterval;  // số iteration giữa hai lần đồng bộ island
+    int migrationSize;      // số colony mỗi island gửi đi mỗi epoch
+    unsigned int seed;      // 0 → lấy theo thời gian
+    size_t duplicateFilterBytes;  // bộ nhớ cho bộ lọc lời giải trùng (mỗi island một bộ)
+    size_t decodeCacheSize;       // số hoán vị trong cache decode của mỗi thread, 0 → tắt
+    MigrationChannel* channel;  // != nullptr → trao đổi với các process khác
+    
+    ICAHGSOptions() : numThreads(1), numIslands(0), migrationInterval(10),
+                      migrationSize(1), seed(0),
+                      duplicateFilterBytes(DuplicateFilter::DEFAULT_MEMORY_BYTES),
+                      decodeCacheSize(DecodeCache::DEFAULT_CAPACITY),
+                      channel(nullptr) {}
+};
+
 class ICAHGS {
 public:
-    ICAHGS(const Instance& inst, int popSize = 50, int numEmpires = 5);
-    ~ICAHGS();  // ← THÊM DESTRUCTOR
-    std::vector<Solution> run(int maxIterations = 100);
+    ICAHGS(const Instance& inst, int popSize = 50, int numEmpires = 5,
+           const ICAHGSOptions& opts = ICAHGSOptions());
+    std::vector<FlatSolution> run(int maxIterations = 100);
 
 private:
     const Instance& instance;
+    ICAHGSOptions options;
     Decoder decoder;
     LocalSearch localSearch;
     
     int populationSize;
     int numImperialists;
+    std::vector<Individual> population;  // pool cố định, cấp phát một lần mỗi run
     std::vector<Empire> empires;
-    std::vector<Solution> paretoArchive;
+    ParetoArchive paretoArchive;
     
     std::mt19937 rng;
     
-    // **THÊM MỚI: Hash manager & duplicate tracker**
-    SolutionHasher* hasher;  // ← THÊM
-    std::unordered_set<uint64_t> seenHashes;  // ← THÊM
+    // **THÊM MỚI: Duplicate tracker** (hash do Decoder/LocalSearch cập nhật)
+    DuplicateFilter seenHashes;  // hash lời giải đã gặp, bộ nhớ cố định
+    
+    // Buffer offspring của một thread, dùng lại qua mọi iteration (đổi chỗ với
+    // colony khi thay thế nên không copy, không cấp phát)
+    struct OffspringScratch {
+        std::vector<int> permutation;
+        Solution solution;
+    };
+    OffspringScratch mainScratch;
+    DecodeCache decodeCache;  // cache decode của thread chính
+    
+    // Đánh giá offspring song song: mỗi worker có Decoder, LocalSearch riêng
+    // (RNG theo task, xem OffspringResult::seed)
+    struct Worker {
+        Decoder decoder;
+        LocalSearch localSearch;
+        OffspringScratch scratch;
+        DecodeCache decodeCache;
+        
+        Worker(const Instance& inst, const ICAHGSOptions& opts)
+            : decoder(inst, opts.decoder), localSearch(inst, opts.localSearch),
+              decodeCache(opts.decodeCacheSize, inst.getNumCustomers(),
+                          inst.numTrucks + inst.getNumCustomers()) {}
+    };
+    
+    // Kết quả của một colony, chỉ được gộp vào empires/archive sau khi cả lô xong
+    struct OffspringResult {
+        int empireIdx;
+        int colonyIdx;
+        unsigned int seed;       // rút từ rng chính theo thứ tự task → không phụ thuộc worker
+        bool skipped;            // trùng lặp với seenHashes lúc bắt đầu lô
+        uint64_t decodedHash;    // hash sau decode (trước local search)
+        std::vector<int> permutation;
+        Solution solution;
+    };
+    
+    // Island model: trạng thái riêng của mỗi island, không chia sẻ giữa các epoch
+    struct Island {
+        std::vector<int> empireIds;
+        std::mt19937 rng;
+        DuplicateFilter seenHashes;
+        ParetoArchive archive;  // Pareto archive cục bộ
+    };
+    std::vector<Island> islands;
+    
+    std::unique_ptr<ThreadPool> pool;
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::vector<OffspringResult> offspringResults;
 
     // Initialization
     void initializePopulation();
-    void createEmpires(std::vector<Individual>& population);
+    void createEmpires();
 
     // **THÊM MỚI: Duplicate detection**
     bool isDuplicate(Solution& solution);  // ← THÊM
+    static bool isDuplicate(Solution& solution, DuplicateFilter& seenHashes);
+    // Decode vào solution, trừ khi cache đã có hoán vị này (khi đó trả về entry
+    // và solution không bị đụng tới). decodedHash nhận hash sau decode.
+    static const DecodeCache::Entry* decodeCached(const std::vector<int>& permutation,
+                                                  Decoder& dec, DecodeCache& cache,
+                                                  Solution& solution, uint64_t& decodedHash);
+    void printDecodeCacheStats() const;
     
     // ICA operations
     void assimilationAndRevolution();
+    void assimilateEmpire(Empire& empire, Decoder& dec, LocalSearch& ls,
+                          std::mt19937& gen, DuplicateFilter& seen,
+                          ParetoArchive& archive, OffspringScratch& scratch,
+                          DecodeCache& cache);
+    void assimilationAndRevolutionParallel();
+    void runIslands(int maxIterations);
+    void migrateColonies();
+    void exchangeMigrants();
+    void evaluateOffspring(Worker& worker, OffspringResult& result);
     void imperialisticCompetition();
     
     // Genetic operators
-    std::vector<int> orderCrossover(const std::vector<int>& parent1,
-                                   const std::vector<int>& parent2);
-    void mutate(std::vector<int>& permutation, double mutationRate = 0.05);
+    void orderCrossover(const std::vector<int>& parent1,
+                        const std::vector<int>& parent2,
+                        std::vector<int>& offspring,
+                        std::mt19937& gen);
+    void mutate(std::vector<int>& permutation, double mutationRate,
+                std::mt19937& gen);
     
     // Pareto operations
     void updateParetoArchive(const Solution& solution);
@@ -0,0 +1,48 @@
+#ifndef INSERTIONKERNEL_H
+#define INSERTIONKERNEL_H
+
+// Chấm điểm các vị trí chèn một customer vào một truck route (mô hình tốc độ
+// hằng của decoder), dữ liệu route dạng struct-of-arrays để chấm nhiều vị trí
+// một lúc. Route có m customer, vị trí p chèn giữa nodes[p] và nodes[p + 1]:
+//   nodes[0..m+1]      depot, customer 1..m, depot
+//   arrival[0..m-1]    thời điểm xong phục vụ customer thứ i
+//   prevToNext[0..m]   thời gian nodes[p] → nodes[p + 1] (cạnh bị cắt khi chèn ở p)
+// Thời gian giữa customer mới và nodes[j] = timeRow[nodes[j]] (hàng của nó
+// trong Instance::truckTimeMatrix), customer sau vị trí p (downstream) = m - p.
+//
+// Chi phí giống hệt từng bit Decoder::computeTruckInsertionDelta (cùng thứ tự
+// phép tính), hòa → vị trí nhỏ nhất. Chỉ xét p = 1..m; p = 0 và route rỗng
+// (customer đầu không tính chờ) Decoder tự tính.
+struct TruckRouteBatch {
+    const int* nodes;
+    const double* arrival;
+    const double* prevToNext;
+    int size;  // m
+};
+
+struct TruckInsertionCandidate {
+    const double* timeRow;
+    double serviceTime;
+};
+
+struct BatchInsertion {
+    int position;  // -1 nếu m = 0
+    double cost;
+};
+
+namespace InsertionKernel {
+    BatchInsertion bestTruckPositionScalar(const TruckRouteBatch& route,
+                                           const TruckInsertionCandidate& cand);
+#ifdef __AVX2__
+    // 4 vị trí mỗi lần (gather khoảng cách theo nodes)
+    BatchInsertion bestTruckPositionAVX2(const TruckRouteBatch& route,
+                                         const TruckInsertionCandidate& cand);
+#endif
+    // AVX2 nếu build với -mavx2 (vd. -march=native) và route có ít nhất
+    // AVX2_MIN_POSITIONS vị trí, ngược lại scalar
+    const int AVX2_MIN_POSITIONS = 16;
+    BatchInsertion bestTruckPosition(const TruckRouteBatch& route,
+                                     const TruckInsertionCandidate& cand);
+}
+
+#endif // INSERTIONKERNEL_H
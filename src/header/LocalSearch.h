@@ -3,22 +3,46 @@
 
 #include "DataStructures.h"
 #include "Solution.h"
-#include <set>
 #include <utility>
+#include <vector>
+#include <random>
+
+// Tham số local search
+struct LocalSearchParams {
+    int tabuTenure;        // số iteration một (customer, move type) bị cấm
+    int tabuTenureRandom;  // cộng thêm ngẫu nhiên trong [0, tabuTenureRandom]
+    
+    LocalSearchParams() : tabuTenure(7), tabuTenureRandom(0) {}
+};
 
 class LocalSearch {
 public:
-    LocalSearch(const Instance& inst) : instance(inst), evaluator(inst) {}
+    LocalSearch(const Instance& inst, const LocalSearchParams& params = LocalSearchParams()) 
+        : instance(inst), evaluator(inst),
+          hasher(inst.getNumCustomers(), inst.numTrucks, inst.numDrones),
+          tabuTenure(params.tabuTenure), tabuTenureRandom(params.tabuTenureRandom),
+          tabuUntil((inst.getNumCustomers() + 1) * NUM_MOVE_TYPES, 0) {}
     
     Solution improve(const Solution& solution, int maxIterations = 100);
+    // Như improve nhưng ghi kết quả đè lên solution, không cấp phát thêm
+    void improveInPlace(Solution& solution, int maxIterations = 100);
     
 private:
     const Instance& instance;
     SolutionEvaluator evaluator;
+    SolutionHasher hasher;  // giữ solutionHash đúng sau mỗi move
+    Solution workingSolution;   // lời giải đang xét của improve()
+    FlatSolution bestSnapshot;  // bản tốt nhất của improve(), copy không cấp phát
     
-    // Tabu list: stores (customer_id, move_type) pairs
-    std::set<std::pair<int, int>> tabuList;
-    int tabuTenure = 7;
+    // Tabu memory: tabuUntil[customer * NUM_MOVE_TYPES + moveType] = iteration
+    // (theo tabuClock) mà move còn bị cấm. tabuClock tăng đơn điệu qua mọi lần
+    // gọi improve() nên không cần xóa mảng giữa các lần gọi.
+    static const int NUM_MOVE_TYPES = 3;
+    int tabuTenure;
+    int tabuTenureRandom;
+    std::vector<int> tabuUntil;
+    int tabuClock = 0;
+    std::mt19937 tabuRng;
     
     struct Move {
         enum Type { RELOCATE, SWAP, SWAP_STAR };
@@ -33,13 +57,67 @@ private:
                 deltaCost(INF) {}
     };
     
+    // ===== Delta evaluation engine =====
+    // Kết quả đánh giá một route (hoặc một dãy customers chưa áp dụng)
+    struct RouteEval {
+        double completionTime;
+        double waitingTime;
+        bool feasible;
+        
+        RouteEval() : completionTime(0), waitingTime(0), feasible(true) {}
+    };
+    
+    // Mỗi truck route / drone trip là một slot, theo đúng thứ tự evaluator duyệt
+    struct RouteSlot {
+        int type;       // 0 = truck, 1 = drone
+        int vehicleId;
+        int tripId;     // -1 cho truck
+        RouteEval eval;
+    };
+    std::vector<RouteSlot> slots;
+    std::vector<int> droneSlotEnd;  // slot ngay sau trip cuối của mỗi drone
+    
+    // Buffers tái sử dụng giữa các lần thử move (không cấp phát lại)
+    std::vector<int> sourceBuffer, bufferA, bufferB;
+    std::vector<std::pair<int, int>> customerSlots;  // (slot, pos) cho SWAP
+    std::vector<std::pair<int, int>> relocateTargets;  // (truck, pos) cho RELOCATE
+    
+    // customer id → (loại xe, xe, trip, vị trí), cập nhật khi áp dụng move
+    CustomerIndex customerIndex;
+    
+    // Granular neighbourhoods (instance.numNeighbors > 0)
+    std::vector<int> swapSeen;         // tránh thử trùng cặp SWAP
+    int swapStamp = 0;
+    
+    void buildSlots(Solution& solution);
+    const std::vector<int>& slotCustomers(const Solution& solution, int slot) const;
+    RouteEval evaluateSequence(int type, const std::vector<int>& customers);
+    void neighbourObjectives(int slotA, const RouteEval& a,
+                             int slotB, const RouteEval& b,
+                             int extraDrone, const RouteEval& extra,
+                             double& completionTime, double& waitingTime) const;
+    void considerMove(const Solution& solution, const Move& move,
+                      double completionTime, double waitingTime, Move& bestMove);
+    
+    static uint64_t routeKey(const CustomerLocation& loc);
+    int slotOf(const CustomerLocation& loc) const;
+    void collectRelocateTargets(const Solution& solution, int cust,
+                                int s, int p, bool granular);
+    void scoreSwap(const Solution& solution, int slot1, int pos1,
+                   int slot2, int pos2, Move& bestMove);
+    
     Move findBestMove(const Solution& solution);
-    Solution applyMove(const Solution& solution, const Move& move);
+    void applyMove(Solution& solution, const Move& move);
+    
+    // Hash delta của customers[pos] với các láng giềng hiện tại trong route
+    uint64_t linkDeltaAt(uint64_t routeKey, const std::vector<int>& customers,
+                         size_t pos) const;
     
     bool isTabu(int customer, int moveType) const;
     void updateTabuList(int customer, int moveType);
     
-    double calculateDelta(const Solution& current, const Solution& neighbor);
+    double calculateDelta(const Solution& current, double neighborCompletionTime,
+                          double neighborWaitingTime);
 };
 
 #endif // LOCALSEARCH_H
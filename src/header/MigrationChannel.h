@@ -0,0 +1,67 @@
+#ifndef MIGRATIONCHANNEL_H
+#define MIGRATIONCHANNEL_H
+
+#include "DataStructures.h"
+#include <vector>
+#include <string>
+#include <cstdint>
+
+// Kênh trao đổi giữa nhiều process cùng giải một instance trên một máy.
+// Mỗi process (rank 0..numProcs-1) và coordinator (rank = numProcs) bind một
+// Unix-domain datagram socket trong cùng thư mục. Migrant đi theo vòng
+// rank → rank+1, archive được đẩy về coordinator.
+//
+// Mọi lần gửi / nhận trong lúc chạy đều non-blocking: hàng đợi bên nhận đầy
+// hoặc process đó đã chết thì gói bị bỏ qua, không process nào phải chờ.
+class MigrationChannel {
+public:
+    enum MessageType : uint32_t {
+        MIGRANT = 1,   // hoán vị của một cá thể ưu tú
+        ARCHIVE = 2    // một lời giải trong Pareto archive
+    };
+
+    MigrationChannel(const std::string& dir, const std::string& runId,
+                     int rank, int numProcs);
+    ~MigrationChannel();
+
+    bool open();   // bind socket của rank này, false nếu lỗi
+    void close();  // đóng và xóa file socket
+    // Coordinator: xóa file socket còn sót của các process đã bị kill
+    void removePeerSockets();
+
+    int getRank() const { return rank; }
+    bool isCoordinator() const { return rank == numProcs; }
+
+    // Gửi cho process kế tiếp trong vòng
+    bool sendMigrant(const std::vector<int>& permutation);
+    // Lấy tối đa maxCount migrant đang chờ, trả về số migrant nhận được
+    int receiveMigrants(std::vector<std::vector<int>>& migrants, int maxCount);
+
+    // Gửi lời giải trong archive cho coordinator, mỗi lời giải một datagram.
+    // blocking = true chỉ dùng khi kết thúc để coordinator chắc chắn nhận được.
+    bool sendSolution(const FlatSolution& solution, bool blocking);
+    int sendArchive(const std::vector<FlatSolution>& archive, bool blocking);
+    // Coordinator: chờ tối đa timeoutMs cho một lời giải, false nếu không có
+    bool receiveArchive(Solution& solution, int timeoutMs);
+
+private:
+    std::string dir;
+    std::string runId;
+    int rank;
+    int numProcs;
+    int fd;
+    std::vector<char> buffer;
+
+    std::string socketPath(int targetRank) const;
+    bool sendTo(int targetRank, bool blocking);
+    int receive(MessageType expected, int timeoutMs);
+
+    void beginMessage(MessageType type);
+    void appendInt(int32_t value);
+    void appendDouble(double value);
+    void appendRoute(const RouteView& route);
+
+    static bool decodeSolution(const char* data, size_t size, Solution& solution);
+};
+
+#endif // MIGRATIONCHANNEL_H
@@ -0,0 +1,54 @@
+#ifndef OBJECTIVESTORE_H
+#define OBJECTIVESTORE_H
+
+#include <vector>
+#include <cstddef>
+
+// Bảng mục tiêu dạng struct-of-arrays: completionTimes[i], waitingTimes[i] là
+// (systemCompletionTime, totalSampleWaitingTime) của slot i. Các phép so sánh
+// trội chỉ đọc hai mảng liên tục này thay vì các Solution nằm rải rác.
+class ObjectiveStore {
+public:
+    void clear();
+    void reserve(size_t n);
+    size_t size() const { return completionTimes.size(); }
+
+    int add(double completionTime, double waitingTime);
+    void set(size_t slot, double completionTime, double waitingTime);
+    void insert(size_t pos, double completionTime, double waitingTime);
+    void erase(size_t first, size_t last);
+
+    double completionTime(size_t slot) const { return completionTimes[slot]; }
+    double waitingTime(size_t slot) const { return waitingTimes[slot]; }
+    const double* completionData() const { return completionTimes.data(); }
+    const double* waitingData() const { return waitingTimes.data(); }
+
+    // Số phần tử liên tiếp từ begin bị (ct, wt) trội hoặc trùng
+    size_t weaklyDominatedRun(double ct, double wt, size_t begin) const;
+
+private:
+    std::vector<double> completionTimes;
+    std::vector<double> waitingTimes;
+};
+
+// Kernel so sánh một ứng viên với nhiều phần tử. Dùng AVX2 / SSE2 khi trình
+// biên dịch bật (-mavx2, SSE2 mặc định trên x86-64), ngược lại chạy vô hướng.
+namespace DominanceKernels {
+    // Độ dài đoạn đầu mà mọi i có ct <= cts[i] && wt <= wts[i]
+    size_t weaklyDominatedRun(const double* cts, const double* wts, size_t count,
+                              double ct, double wt);
+    // Bản vô hướng, dùng làm fallback và để đối chiếu
+    size_t weaklyDominatedRunScalar(const double* cts, const double* wts, size_t count,
+                                    double ct, double wt);
+    // Từng đường SIMD riêng (cho bench/dominance_kernels.cpp)
+#ifdef __SSE2__
+    size_t weaklyDominatedRunSSE2(const double* cts, const double* wts, size_t count,
+                                  double ct, double wt);
+#endif
+#ifdef __AVX2__
+    size_t weaklyDominatedRunAVX2(const double* cts, const double* wts, size_t count,
+                                  double ct, double wt);
+#endif
+}
+
+#endif // OBJECTIVESTORE_H
@@ -0,0 +1,43 @@
+#ifndef PARETOARCHIVE_H
+#define PARETOARCHIVE_H
+
+#include "DataStructures.h"
+#include "ObjectiveStore.h"
+#include <vector>
+
+// Pareto archive cho 2 mục tiêu (systemCompletionTime, totalSampleWaitingTime).
+// Tập không bị trội là một "bậc thang": sắp tăng theo completion time thì
+// waiting time giảm ngặt. Nhờ vậy kiểm tra trội chỉ cần một binary search, và
+// các phần tử bị lời giải mới trội luôn nằm liền nhau ngay sau vị trí chèn.
+//
+// Mục tiêu nằm trong ObjectiveStore (SoA, theo thứ tự bậc thang); route được
+// lưu riêng dạng FlatSolution trong payloads (slot tái sử dụng qua freeSlots),
+// nên lời giải bị loại không bao giờ bị copy.
+class ParetoArchive {
+public:
+    // Thêm nếu không bị trội (hoặc trùng mục tiêu) bởi phần tử nào, xóa các
+    // phần tử bị nó trội. Trả về true nếu đã thêm.
+    bool insert(const Solution& solution);
+    bool insert(const FlatSolution& solution);
+
+    void clear();
+    size_t size() const { return slots.size(); }
+    bool empty() const { return slots.empty(); }
+
+    // Phần tử thứ i theo completion time tăng dần
+    const FlatSolution& operator[](size_t i) const { return payloads[slots[i]]; }
+    const ObjectiveStore& objectives() const { return objectiveStore; }
+
+    std::vector<FlatSolution> toVector() const;
+
+private:
+    // Cập nhật bậc thang cho (ct, wt), trả về slot payload cần ghi hoặc -1
+    int acquireSlot(double ct, double wt);
+
+    ObjectiveStore objectiveStore;  // objectiveStore[i] ↔ payloads[slots[i]]
+    std::vector<int> slots;
+    std::vector<FlatSolution> payloads;
+    std::vector<int> freeSlots;
+};
+
+#endif // PARETOARCHIVE_H
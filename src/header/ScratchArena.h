@@ -0,0 +1,66 @@
+#ifndef SCRATCHARENA_H
+#define SCRATCHARENA_H
+
+#include <vector>
+#include <memory>
+#include <cstddef>
+#include <type_traits>
+
+// Arena tăng dần (bump allocator) cho buffer tạm trong vòng lặp tìm kiếm.
+// Mỗi thread có một arena riêng (local()), được reset một lần cho mỗi
+// offspring. Nếu một offspring cần nhiều hơn block hiện có, arena xin thêm
+// block; lần reset sau gộp lại thành một block đủ lớn, nên ở trạng thái ổn
+// định không còn cấp phát heap nào.
+//
+// Chỉ dùng cho kiểu trivially destructible: không có destructor nào được gọi.
+class ScratchArena {
+public:
+    static ScratchArena& local();
+
+    template <typename T>
+    T* allocate(size_t count) {
+        static_assert(std::is_trivially_destructible<T>::value,
+                      "ScratchArena chỉ chứa kiểu trivially destructible");
+        return static_cast<T*>(allocateBytes(count * sizeof(T), alignof(T)));
+    }
+
+    // Thu hồi mọi vùng đã cấp phát
+    void reset();
+
+    size_t capacity() const;
+
+    // Trả arena về vị trí lúc tạo Scope khi ra khỏi phạm vi (cho buffer tạm
+    // trong vòng lặp, tránh để arena phình theo số lần thử)
+    class Scope {
+    public:
+        explicit Scope(ScratchArena& arena)
+            : arena(arena), savedBlock(arena.currentBlock), savedOffset(arena.offset) {}
+        ~Scope() {
+            arena.currentBlock = savedBlock;
+            arena.offset = savedOffset;
+        }
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        ScratchArena& arena;
+        size_t savedBlock;
+        size_t savedOffset;
+    };
+
+private:
+    struct Block {
+        std::unique_ptr<char[]> data;
+        size_t size;
+    };
+
+    static const size_t INITIAL_BLOCK_SIZE = 64 * 1024;
+
+    std::vector<Block> blocks;
+    size_t currentBlock = 0;
+    size_t offset = 0;
+
+    void* allocateBytes(size_t bytes, size_t alignment);
+};
+
+#endif // SCRATCHARENA_H
@@ -2,9 +2,6 @@
 #define SOLUTION_H
 
 #include "DataStructures.h"
-#include <map>         // ← THÊM (cho std::map)
-#include <tuple>       // ← THÊM (cho std::tuple)
-#include <random>      // ← THÊM (cho std::mt19937_64)
 #include <cstdint>
 
 class SolutionEvaluator {
@@ -12,6 +9,14 @@ public:
     SolutionEvaluator(const Instance& inst) : instance(inst) {}
     
     void evaluate(Solution& solution);
+    void evaluate(FlatSolution& solution);
+    
+    // Đánh giá một dãy customers như một route mà không cần tạo Route/Solution
+    // (dùng cho delta evaluation trong LocalSearch). Cùng công thức với evaluate.
+    void evaluateTruckSequence(const int* customers, int count,
+                               double& completionTime, double& waitingTime);
+    bool evaluateDroneSequence(const int* customers, int count,
+                               double& completionTime, double& waitingTime);
     
 private:
     const Instance& instance;
@@ -27,6 +32,7 @@ private:
     
     // Calculate drone energy consumption
     double calculateDroneEnergy(const Route& route);
+    double calculateDroneEnergy(const int* customers, int count);
     
     // Get speed factor at given time
     double getSpeedFactor(double time) const;
@@ -40,18 +46,53 @@ public:
 };
 
 // **THÊM MỚI: Zobrist Hashing để detect duplicates**
+// Hash = XOR của các cạnh (route, prev, next) trong mọi route, kể cả cạnh
+// depot→đầu và cuối→depot. Giá trị mỗi cạnh sinh bằng hàm trộn có khóa,
+// không cần bảng. Relocate/swap/insert chỉ đổi O(1) cạnh → cập nhật O(1).
 class SolutionHasher {
 public:
     SolutionHasher(int maxCustomers, int maxTrucks, int maxDrones);
     
     // Tính hash của solution
     uint64_t computeHash(const Solution& solution) const;
+    uint64_t computeHash(const FlatSolution& solution) const;
+    
+    // Route keys
+    static uint64_t truckRouteKey(int truckId) { return (uint64_t)truckId; }
+    static uint64_t droneRouteKey(int droneId, int tripId) {
+        return (1ULL << 63) | ((uint64_t)droneId << 32) | (uint32_t)tripId;
+    }
+    
+    uint64_t edgeKey(uint64_t routeKey, int from, int to) const {
+        uint64_t h = mix(seed ^ routeKey);
+        return mix(h ^ (((uint64_t)(uint32_t)from << 32) | (uint32_t)to));
+    }
+    
+    // XOR delta khi chèn (hoặc xóa) cust giữa prev và next (0 = depot).
+    // Chèn và xóa cho cùng một delta.
+    uint64_t linkDelta(uint64_t routeKey, int prev, int cust, int next) const {
+        uint64_t delta = edgeKey(routeKey, prev, cust) ^ edgeKey(routeKey, cust, next);
+        if (prev != 0 || next != 0) {
+            delta ^= edgeKey(routeKey, prev, next);  // route rỗng không có cạnh depot→depot
+        }
+        return delta;
+    }
+    
+    // XOR delta khi hoán đổi a (giữa prevA, nextA) với b (giữa prevB, nextB)
+    uint64_t swapDelta(uint64_t routeKeyA, int prevA, int a, int nextA,
+                       uint64_t routeKeyB, int prevB, int b, int nextB) const;
     
 private:
-    // Zobrist table: [customer_id][route_id][position] → random number
-    std::map<std::tuple<int, int, int>, uint64_t> zobristTable;
+    uint64_t seed;
+    
+    static uint64_t mix(uint64_t x) {  // splitmix64 finalizer
+        x += 0x9e3779b97f4a7c15ULL;
+        x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+        return x ^ (x >> 31);
+    }
     
-    void initializeZobristTable(int maxCustomers, int maxTrucks, int maxDrones);
+    uint64_t routeHash(uint64_t routeKey, const int* customers, int count) const;
 };
 
 #endif // SOLUTION_H
@@ -0,0 +1,39 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <atomic>
+
+// Thread pool cố định: run() chia numTasks task cho các worker (lấy task
+// động qua bộ đếm atomic) và chờ đến khi tất cả xong.
+class ThreadPool {
+public:
+    explicit ThreadPool(int numThreads);
+    ~ThreadPool();
+    
+    int size() const { return threads.size(); }
+    
+    // Gọi fn(taskId, workerId) cho taskId = 0..numTasks-1
+    void run(int numTasks, const std::function<void(int, int)>& fn);
+    
+private:
+    std::vector<std::thread> threads;
+    std::mutex mutex;
+    std::condition_variable startCv;
+    std::condition_variable doneCv;
+    
+    const std::function<void(int, int)>* job = nullptr;
+    int jobTasks = 0;
+    std::atomic<int> nextTask{0};
+    int busyWorkers = 0;
+    unsigned long generation = 0;
+    bool stopping = false;
+    
+    void workerLoop(int workerId);
+};
+
+#endif // THREADPOOL_H
@@ -10,10 +10,15 @@
 #include <ctime>     // Cần cho hàm clock
 #include <set>       // Để lọc các giải pháp duy nhất
 #include <utility>   // Để sử dụng std::pair
+#include <chrono>
+#include <cstdio>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
 
 using namespace std;
 
-void printSolution(const Solution& solution, int index) {
+void printSolution(const FlatSolution& solution, int index) {
     cout << "\n--- Solution " << index << " ---" << endl;
     cout << "System Completion Time: " << fixed << setprecision(2) 
          << solution.systemCompletionTime << " seconds" << endl;
@@ -21,11 +26,11 @@ void printSolution(const Solution& solution, int index) {
          << " seconds" << endl;
     
     cout << "\nTruck Routes:" << endl;
-    for (size_t i = 0; i < solution.truckRoutes.size(); i++) {
-        const auto& route = solution.truckRoutes[i];
+    for (int i = 0; i < solution.numTrucks; i++) {
+        RouteView route = solution.truckRoute(i);
         if (!route.isEmpty()) {
             cout << "  Truck " << i << ": Depot -> ";
-            for (int cust : route.customers) {
+            for (int cust : route) {
                 cout << cust << " -> ";
             }
             cout << "Depot (Completion: " << route.completionTime 
@@ -34,23 +39,24 @@ void printSolution(const Solution& solution, int index) {
     }
     
     cout << "\nDrone Routes:" << endl;
-    for (size_t i = 0; i < solution.droneRoutes.size(); i++) {
-        const auto& trips = solution.droneRoutes[i];
-        if (!trips.empty()) {
+    for (int i = 0; i < solution.numDrones; i++) {
+        int numTrips = solution.numTrips(i);
+        if (numTrips > 0) {
             cout << "  Drone " << i << ":" << endl;
-            for (size_t j = 0; j < trips.size(); j++) {
+            for (int j = 0; j < numTrips; j++) {
+                RouteView trip = solution.droneTrip(i, j);
                 cout << "    Trip " << j << ": Depot -> ";
-                for (int cust : trips[j].customers) {
+                for (int cust : trip) {
                     cout << cust << " -> ";
                 }
-                cout << "Depot (Completion: " << trips[j].completionTime 
+                cout << "Depot (Completion: " << trip.completionTime 
                       << "s)" << endl;
             }
         }
     }
 }
 
-void exportResults(const vector<Solution>& paretoFront, 
+void exportResults(const vector<FlatSolution>& paretoFront, 
                    const string& filename) {
     ofstream file(filename);
     
@@ -78,48 +84,14 @@ void exportResults(const vector<Solution>& paretoFront,
     cout << "\nUnique results exported to: " << filename << endl;
 }
 
-int main(int argc, char* argv[]) {
-    cout << "=== ICAHGS for MSSVTDE ===" << endl;
-    
-    string filename = "data/6.5.1.txt";
-    if (argc > 1) {
-        filename = argv[1];
-    }
-    
-    Instance instance;
-    if (!InputReader::readInstance(filename, instance)) {
-        cerr << "Failed to read instance file." << endl;
-        return 1;
-    }
-    
-    cout << "\nInstance loaded successfully!" << endl;
-    cout << "  Customers: " << instance.getNumCustomers() << endl;
-    cout << "  Trucks: " << instance.numTrucks << endl;
-    cout << "  Drones: " << instance.numDrones << endl;
-    
-    int populationSize = 50;
-    int numEmpires = 5;
-    int maxIterations = 100;
-    
-    if (argc > 2) populationSize = stoi(argv[2]);
-    if (argc > 3) numEmpires = stoi(argv[3]);
-    if (argc > 4) maxIterations = stoi(argv[4]);
-    
-    ICAHGS algorithm(instance, populationSize, numEmpires);
-    
-    auto startTime = clock();
-    vector<Solution> paretoFront = algorithm.run(maxIterations);
-    auto endTime = clock();
-    
-    double elapsedTime = double(endTime - startTime) / CLOCKS_PER_SEC;
-    
+void reportResults(vector<FlatSolution>& paretoFront, double elapsedTime) {
     cout << "\n=== Results ===" << endl;
     cout << "Computation time: " << elapsedTime << " seconds" << endl;
     cout << "Pareto front size: " << paretoFront.size() << endl;
     
     // Sắp xếp Pareto front để hiển thị kết quả đa dạng
     sort(paretoFront.begin(), paretoFront.end(), 
-              [](const Solution& a, const Solution& b) {
+              [](const FlatSolution& a, const FlatSolution& b) {
         if (a.systemCompletionTime != b.systemCompletionTime) {
             return a.systemCompletionTime < b.systemCompletionTime;
         }
@@ -147,6 +119,267 @@ int main(int argc, char* argv[]) {
 
     // Export results
     exportResults(paretoFront, "results.csv");
+}
+
+// Lời giải nhận từ process khác: chỉ chấp nhận route chứa customer hợp lệ
+bool isValidSolution(const Solution& solution, const Instance& instance) {
+    int n = instance.getNumCustomers();
+    if ((int)solution.truckRoutes.size() != instance.numTrucks ||
+        (int)solution.droneRoutes.size() != instance.numDrones) {
+        return false;
+    }
+    auto validRoute = [n](const Route& route) {
+        for (int cust : route.customers) {
+            if (cust < 1 || cust > n) return false;
+        }
+        return true;
+    };
+    for (const auto& route : solution.truckRoutes) {
+        if (!validRoute(route)) return false;
+    }
+    for (const auto& trips : solution.droneRoutes) {
+        for (const auto& trip : trips) {
+            if (!validRoute(trip)) return false;
+        }
+    }
+    return true;
+}
+
+// Chạy numProcs process giải độc lập (fork), trao đổi migrant qua Unix-domain
+// socket trong channelDir. Process cha làm coordinator: gộp archive mà các
+// process đẩy về (định kỳ và lúc kết thúc) thành Pareto front chung. Process
+// con bị crash chỉ làm mất phần đóng góp sau lần đẩy archive cuối của nó.
+int runMultiProcess(const Instance& instance, int numProcs, const string& channelDir,
+                    int populationSize, int numEmpires, int maxIterations,
+                    ICAHGSOptions options) {
+    string runId = to_string(getpid());
+    MigrationChannel coordinator(channelDir, runId, numProcs, numProcs);
+    if (!coordinator.open()) {
+        cerr << "Cannot open coordinator socket in " << channelDir << endl;
+        return 1;
+    }
+    
+    unsigned int baseSeed = options.seed != 0 ? options.seed
+                                              : static_cast<unsigned int>(time(nullptr));
+    auto startTime = chrono::steady_clock::now();
+    
+    vector<pid_t> children;
+    for (int rank = 0; rank < numProcs; rank++) {
+        cout.flush();
+        pid_t pid = fork();
+        if (pid < 0) {
+            cerr << "fork failed for process " << rank << endl;
+            break;
+        }
+        if (pid == 0) {
+            // Không gọi coordinator.close(): file socket thuộc về process cha
+            // Chỉ process 0 in tiến trình ra màn hình
+            if (rank > 0 && !freopen("/dev/null", "w", stdout)) {
+                _exit(1);
+            }
+            
+            MigrationChannel channel(channelDir, runId, rank, numProcs);
+            if (!channel.open()) {
+                cerr << "Process " << rank << ": cannot open socket" << endl;
+                _exit(1);
+            }
+            options.seed = baseSeed + rank;
+            options.channel = &channel;
+            
+            ICAHGS algorithm(instance, populationSize, numEmpires, options);
+            vector<FlatSolution> front = algorithm.run(maxIterations);
+            channel.sendArchive(front, true);
+            channel.close();
+            cout.flush();
+            _exit(0);
+        }
+        children.push_back(pid);
+    }
+    
+    cout << "Started " << children.size() << " solver processes" << endl;
+    
+    // Coordinator: nhận archive cho đến khi mọi process đã thoát và hết gói chờ
+    SolutionEvaluator evaluator(instance);
+    ParetoArchive mergedArchive;
+    int running = children.size();
+    int failed = 0;
+    while (true) {
+        Solution solution;
+        if (coordinator.receiveArchive(solution, running > 0 ? 200 : 0)) {
+            if (isValidSolution(solution, instance)) {
+                evaluator.evaluate(solution);
+                mergedArchive.insert(solution);
+            }
+            continue;
+        }
+        if (running == 0) break;
+        
+        int status;
+        while (running > 0 && waitpid(-1, &status, WNOHANG) > 0) {
+            running--;
+            if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+                cerr << "A solver process terminated abnormally" << endl;
+                failed++;
+            }
+        }
+    }
+    coordinator.removePeerSockets();
+    coordinator.close();
+    
+    // Không process nào chạy xong: báo lỗi cho job scheduler, không ghi front rỗng
+    if (failed == (int)children.size()) {
+        cerr << "All " << children.size() << " solver processes failed" << endl;
+        return 1;
+    }
+    if (failed > 0) {
+        cerr << failed << " of " << children.size()
+             << " solver processes failed, results are partial" << endl;
+    }
+    
+    double elapsedTime = chrono::duration<double>(
+        chrono::steady_clock::now() - startTime).count();
+    vector<FlatSolution> paretoFront = mergedArchive.toVector();
+    reportResults(paretoFront, elapsedTime);
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    cout << "=== ICAHGS for MSSVTDE ===" << endl;
+    
+    // Tham số vị trí: file popSize numEmpires maxIterations
+    // Tùy chọn dạng "--key value":
+    //   --neighbors K     kích thước candidate list của local search (0 = đầy đủ)
+    //   --tabu-tenure T   số iteration một move bị cấm
+    //   --tabu-random R   tenure ngẫu nhiên thêm trong [0, R]
+    //   --threads N       số thread đánh giá offspring song song
+    //   --islands K       island model với K island (mặc định 1 thread / island)
+    //   --migration-interval I   số iteration giữa hai lần di cư
+    //   --migration-size M       số colony mỗi island gửi đi mỗi lần
+    //   --procs P         chạy P process song song, trao đổi migrant qua socket
+    //   --channel-dir D   thư mục chứa Unix-domain socket (mặc định /tmp)
+    //   --seed S          seed của RNG (mặc định theo thời gian)
+    //   --dup-filter-mb M bộ nhớ (MB) cho bộ lọc lời giải trùng (mặc định 16)
+    //   --decode-cache C  số hoán vị trong cache decode mỗi thread (0 = tắt)
+    //   --decoder D       insertion (mặc định) hoặc split
+    //   --split-max-route L  số customer tối đa của một truck route khi split
+    //   --decode-checkpoint C  lưu trạng thái decode của imperialist mỗi C customer,
+    //                     offspring chung prefix chỉ decode lại phần đuôi (0 = tắt)
+    //   --regret-k K      decode insertion chèn customer có regret-k lớn nhất trước,
+    //                     hoán vị chỉ để phá hòa (0 = theo thứ tự hoán vị)
+    int numNeighbors = 20;
+    int numProcs = 1;
+    string channelDir = "/tmp";
+    ICAHGSOptions options;
+    vector<string> args;
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (arg.rfind("--", 0) != 0) {
+            args.push_back(arg);
+            continue;
+        }
+        if (i + 1 >= argc) {
+            cerr << "Missing value for option " << arg << endl;
+            return 1;
+        }
+        string value = argv[++i];
+        if (arg == "--neighbors") {
+            numNeighbors = stoi(value);
+        } else if (arg == "--tabu-tenure") {
+            options.localSearch.tabuTenure = stoi(value);
+        } else if (arg == "--tabu-random") {
+            options.localSearch.tabuTenureRandom = stoi(value);
+        } else if (arg == "--threads") {
+            options.numThreads = stoi(value);
+        } else if (arg == "--islands") {
+            options.numIslands = stoi(value);
+        } else if (arg == "--migration-interval") {
+            options.migrationInterval = stoi(value);
+            if (options.migrationInterval < 1) {
+                cerr << "--migration-interval must be >= 1" << endl;
+                return 1;
+            }
+        } else if (arg == "--migration-size") {
+            options.migrationSize = stoi(value);
+            if (options.migrationSize < 0) {
+                cerr << "--migration-size must be >= 0" << endl;
+                return 1;
+            }
+        } else if (arg == "--procs") {
+            numProcs = stoi(value);
+        } else if (arg == "--channel-dir") {
+            channelDir = value;
+        } else if (arg == "--seed") {
+            options.seed = stoul(value);
+        } else if (arg == "--dup-filter-mb") {
+            options.duplicateFilterBytes = (size_t)stoul(value) << 20;
+        } else if (arg == "--decode-cache") {
+            options.decodeCacheSize = stoul(value);
+        } else if (arg == "--decoder") {
+            if (value == "insertion") {
+                options.decoder.mode = DecoderParams::INSERTION;
+            } else if (value == "split") {
+                options.decoder.mode = DecoderParams::SPLIT;
+            } else {
+                cerr << "Unknown decoder: " << value << endl;
+                return 1;
+            }
+        } else if (arg == "--split-max-route") {
+            options.decoder.splitMaxRouteLength = stoi(value);
+        } else if (arg == "--decode-checkpoint") {
+            options.decoder.checkpointInterval = stoi(value);
+        } else if (arg == "--regret-k") {
+            options.decoder.regretK = stoi(value);
+            if (options.decoder.regretK == 1 || options.decoder.regretK < 0) {
+                cerr << "--regret-k must be 0 or >= 2" << endl;
+                return 1;
+            }
+        } else {
+            cerr << "Unknown option: " << arg << endl;
+            return 1;
+        }
+    }
+    
+    string filename = "data/6.5.1.txt";
+    if (args.size() > 0) {
+        filename = args[0];
+    }
+    
+    Instance instance;
+    if (!InputReader::readInstance(filename, instance)) {
+        cerr << "Failed to read instance file." << endl;
+        return 1;
+    }
+    
+    cout << "\nInstance loaded successfully!" << endl;
+    cout << "  Customers: " << instance.getNumCustomers() << endl;
+    cout << "  Trucks: " << instance.numTrucks << endl;
+    cout << "  Drones: " << instance.numDrones << endl;
+    
+    int populationSize = 50;
+    int numEmpires = 5;
+    int maxIterations = 100;
+    
+    if (args.size() > 1) populationSize = stoi(args[1]);
+    if (args.size() > 2) numEmpires = stoi(args[2]);
+    if (args.size() > 3) maxIterations = stoi(args[3]);
+    
+    instance.buildNeighborLists(numNeighbors);
+    cout << "  Neighbor list size: " << instance.numNeighbors << endl;
+    
+    if (numProcs > 1) {
+        return runMultiProcess(instance, numProcs, channelDir, populationSize,
+                               numEmpires, maxIterations, options);
+    }
+    
+    ICAHGS algorithm(instance, populationSize, numEmpires, options);
+    
+    auto startTime = clock();
+    vector<FlatSolution> paretoFront = algorithm.run(maxIterations);
+    auto endTime = clock();
+    
+    double elapsedTime = double(endTime - startTime) / CLOCKS_PER_SEC;
+    
+    reportResults(paretoFront, elapsedTime);
     
     return 0;
 }